@@ -0,0 +1,45 @@
+#ifndef BIG_BATCH_H
+#define BIG_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "big_integer.h"
+#include "limb_resource.h"
+
+// size() non-negative integers of limbs() limbs each, stored limb-major:
+// limb l of integer i is row(l)[i]. The batch_* kernels walk each row of
+// many integers at once, one integer per SIMD lane.
+class big_batch
+{
+public:
+    big_batch(size_t count, size_t limbs);
+    // throws std::invalid_argument if a value is negative or too wide
+    big_batch(std::vector<big_integer> const& values, size_t limbs);
+
+    size_t size() const;
+    size_t limbs() const;
+    uint32_t* row(size_t l);
+    uint32_t const* row(size_t l) const;
+
+    big_integer get(size_t i) const;
+    void set(size_t i, big_integer const& value);
+    std::vector<big_integer> to_vector() const;
+
+private:
+    size_t count;
+    size_t width;
+    std::vector<uint32_t, limb_allocator<uint32_t>> data;
+};
+
+// r = a + b and r = a * b, modulo 2^(32 * r.limbs()) like big_uint; give r
+// one more limb than the operands for the exact sum, or their total for the
+// exact product. All three batches must be of the same size.
+void batch_add(big_batch& r, big_batch const& a, big_batch const& b);
+void batch_mul(big_batch& r, big_batch const& a, big_batch const& b);
+// r = a mod m in every lane by Barrett reduction; m > 0 and r must have at
+// least as many limbs as m
+void batch_mod(big_batch& r, big_batch const& a, big_integer const& m);
+
+#endif // BIG_BATCH_H
@@ -0,0 +1,370 @@
+#include "big_decimal.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+typedef std::vector<uint32_t, limb_allocator<uint32_t>> decimal_limbs;
+
+static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// The helpers work on magnitudes without leading zero limbs; 0 has none.
+
+static void trim_limbs(decimal_limbs& a) {
+    while (!a.empty() && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+static int cmp_limbs(decimal_limbs const& a, decimal_limbs const& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// a += b
+static void add_limbs(decimal_limbs& a, decimal_limbs const& b) {
+    if (a.size() < b.size()) {
+        a.resize(b.size());
+    }
+    uint32_t carry = 0;
+    for (size_t i = 0; i < a.size() && (i < b.size() || carry); i++) {
+        uint32_t s = a[i] + (i < b.size() ? b[i] : 0) + carry;
+        carry = (s >= big_decimal::BASE);
+        a[i] = (carry ? s - big_decimal::BASE : s);
+    }
+    if (carry) {
+        a.push_back(carry);
+    }
+}
+
+// a -= b, where a >= b
+static void sub_limbs(decimal_limbs& a, decimal_limbs const& b) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < a.size() && (i < b.size() || borrow); i++) {
+        uint32_t x = (i < b.size() ? b[i] : 0) + borrow;
+        borrow = (a[i] < x);
+        a[i] = (borrow ? a[i] + big_decimal::BASE - x : a[i] - x);
+    }
+    trim_limbs(a);
+}
+
+// a = a * m + c, with m and c below BASE
+static void mul_small(decimal_limbs& a, uint32_t m, uint32_t c) {
+    uint64_t carry = c;
+    for (uint32_t& x : a) {
+        uint64_t cur = static_cast<uint64_t>(x) * m + carry;
+        x = static_cast<uint32_t>(cur % big_decimal::BASE);
+        carry = cur / big_decimal::BASE;
+    }
+    if (carry) {
+        a.push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// a *= 10^d
+static void shift_up(decimal_limbs& a, size_t d) {
+    if (a.empty()) {
+        return;
+    }
+    a.insert(a.begin(), d / big_decimal::BASE_DIGITS, 0);
+    mul_small(a, POW10[d % big_decimal::BASE_DIGITS], 0);
+}
+
+// a /= 10^d, rounding half away from zero: only the first dropped digit
+// decides that
+static void shift_down(decimal_limbs& a, size_t d) {
+    if (d == 0) {
+        return;
+    }
+    size_t pos = d - 1;
+    size_t limb = pos / big_decimal::BASE_DIGITS;
+    bool up = (limb < a.size() && (a[limb] / POW10[pos % big_decimal::BASE_DIGITS]) % 10 >= 5);
+    size_t drop = std::min(d / big_decimal::BASE_DIGITS, a.size());
+    a.erase(a.begin(), a.begin() + drop);
+    uint32_t m = POW10[d % big_decimal::BASE_DIGITS];
+    uint64_t rem = 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        uint64_t cur = rem * big_decimal::BASE + a[i];
+        a[i] = static_cast<uint32_t>(cur / m);
+        rem = cur % m;
+    }
+    trim_limbs(a);
+    if (up) {
+        add_limbs(a, decimal_limbs(1, 1));
+    }
+}
+
+big_decimal::big_decimal() : negative(false), point(0) {}
+
+big_decimal::big_decimal(int a) : negative(a < 0), point(0) {
+    uint64_t m = (a < 0 ? -static_cast<int64_t>(a) : a);
+    while (m != 0) {
+        limbs.push_back(static_cast<uint32_t>(m % BASE));
+        m /= BASE;
+    }
+}
+
+big_decimal::big_decimal(big_integer const& unscaled, size_t scale) : negative(unscaled < 0), point(scale) {
+    big_integer x = unscaled;
+    x.sign = false;
+    big_integer const base(static_cast<int>(BASE));
+    while (x != 0) {
+        big_integer r = x % base;
+        limbs.push_back(r.num[0]);
+        x /= base;
+    }
+}
+
+big_decimal::big_decimal(std::string const& str) : negative(false), point(0) {
+    size_t i = 0;
+    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+        negative = (str[i] == '-');
+        i++;
+    }
+    std::string digits;
+    bool seen_point = false;
+    for (; i < str.size(); i++) {
+        if (str[i] == '.' && !seen_point) {
+            seen_point = true;
+        } else if (str[i] >= '0' && str[i] <= '9') {
+            digits.push_back(str[i]);
+            if (seen_point) {
+                point++;
+            }
+        } else {
+            throw std::invalid_argument("invalid decimal");
+        }
+    }
+    if (digits.empty()) {
+        throw std::invalid_argument("invalid decimal");
+    }
+    limbs.reserve(digits.size() / BASE_DIGITS + 1);
+    for (size_t end = digits.size(); end > 0;) {
+        size_t begin = (end > BASE_DIGITS ? end - BASE_DIGITS : 0);
+        uint32_t x = 0;
+        for (size_t j = begin; j < end; j++) {
+            x = x * 10 + (digits[j] - '0');
+        }
+        limbs.push_back(x);
+        end = begin;
+    }
+    trim();
+}
+
+void big_decimal::trim() {
+    trim_limbs(limbs);
+    if (limbs.empty()) {
+        negative = false;
+    }
+}
+
+size_t big_decimal::scale() const {
+    return point;
+}
+
+void big_decimal::rescale(size_t scale) {
+    if (scale > point) {
+        shift_up(limbs, scale - point);
+    } else {
+        shift_down(limbs, point - scale);
+    }
+    point = scale;
+    trim();
+}
+
+big_integer big_decimal::unscaled() const {
+    big_integer res;
+    big_integer const base(static_cast<int>(BASE));
+    for (size_t i = limbs.size(); i-- > 0;) {
+        res *= base;
+        res += big_integer(limbs[i]);
+    }
+    res.sign = negative;
+    return res;
+}
+
+void big_decimal::add(big_decimal const& rhs, bool negate) {
+    if (this == &rhs) {
+        big_decimal copy = rhs;
+        add(copy, negate);
+        return;
+    }
+    bool rhs_negative = (rhs.negative != negate);
+    if (point < rhs.point) {
+        rescale(rhs.point);
+    }
+    decimal_limbs aligned;
+    decimal_limbs const* b = &rhs.limbs;
+    if (rhs.point < point) {
+        aligned = rhs.limbs;
+        shift_up(aligned, point - rhs.point);
+        b = &aligned;
+    }
+    if (negative == rhs_negative) {
+        add_limbs(limbs, *b);
+    } else if (cmp_limbs(limbs, *b) >= 0) {
+        sub_limbs(limbs, *b);
+    } else {
+        decimal_limbs diff = *b;
+        sub_limbs(diff, limbs);
+        limbs = diff;
+        negative = rhs_negative;
+    }
+    trim();
+}
+
+big_decimal& big_decimal::operator+=(big_decimal const& rhs) {
+    add(rhs, false);
+    return *this;
+}
+
+big_decimal& big_decimal::operator-=(big_decimal const& rhs) {
+    add(rhs, true);
+    return *this;
+}
+
+big_decimal& big_decimal::operator*=(big_decimal const& rhs) {
+    decimal_limbs res(limbs.size() + rhs.limbs.size());
+    for (size_t i = 0; i < limbs.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.limbs.size(); j++) {
+            // below BASE^2 + BASE, which fits 64 bits
+            uint64_t cur = res[i + j] + static_cast<uint64_t>(limbs[i]) * rhs.limbs[j] + carry;
+            res[i + j] = static_cast<uint32_t>(cur % BASE);
+            carry = cur / BASE;
+        }
+        res[i + rhs.limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    limbs = res;
+    negative = (negative != rhs.negative);
+    point += rhs.point;
+    trim();
+    return *this;
+}
+
+big_decimal big_decimal::operator+() const {
+    return *this;
+}
+
+big_decimal big_decimal::operator-() const {
+    big_decimal r = *this;
+    r.negative = !r.negative;
+    r.trim();
+    return r;
+}
+
+int big_decimal::sign() const {
+    if (limbs.empty()) {
+        return 0;
+    }
+    return negative ? -1 : 1;
+}
+
+big_decimal operator+(big_decimal a, big_decimal const& b) {
+    return a += b;
+}
+
+big_decimal operator-(big_decimal a, big_decimal const& b) {
+    return a -= b;
+}
+
+big_decimal operator*(big_decimal a, big_decimal const& b) {
+    return a *= b;
+}
+
+big_decimal divide(big_decimal const& a, big_decimal const& b, size_t scale) {
+    if (b.sign() == 0) {
+        throw std::invalid_argument("Division by zero!");
+    }
+    // one digit more than asked for, which rescale then rounds off
+    big_integer n = a.unscaled(), d = b.unscaled();
+    int64_t e = static_cast<int64_t>(scale) + 1 + static_cast<int64_t>(b.scale()) - static_cast<int64_t>(a.scale());
+    if (e >= 0) {
+        n *= pow(big_integer(10), e);
+    } else {
+        d *= pow(big_integer(10), -e);
+    }
+    big_decimal res(n / d, scale + 1);
+    res.rescale(scale);
+    return res;
+}
+
+int compare(big_decimal const& a, big_decimal const& b) {
+    int sa = a.sign(), sb = b.sign();
+    if (sa != sb || sa == 0) {
+        return sa < sb ? -1 : (sa > sb ? 1 : 0);
+    }
+    int res;
+    if (a.point < b.point) {
+        decimal_limbs x = a.limbs;
+        shift_up(x, b.point - a.point);
+        res = cmp_limbs(x, b.limbs);
+    } else {
+        decimal_limbs y = b.limbs;
+        shift_up(y, a.point - b.point);
+        res = cmp_limbs(a.limbs, y);
+    }
+    return sa < 0 ? -res : res;
+}
+
+bool operator==(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) >= 0;
+}
+
+std::string to_string(big_decimal const& a) {
+    std::string res;
+    if (a.negative) {
+        res.push_back('-');
+    }
+    size_t first = res.size();
+    if (a.limbs.empty()) {
+        res.push_back('0');
+    } else {
+        res.reserve(first + a.limbs.size() * big_decimal::BASE_DIGITS + 2);
+        res += std::to_string(a.limbs.back());
+        for (size_t i = a.limbs.size() - 1; i-- > 0;) {
+            std::string part = std::to_string(a.limbs[i]);
+            res.append(big_decimal::BASE_DIGITS - part.size(), '0');
+            res += part;
+        }
+    }
+    if (a.point > 0) {
+        size_t digits = res.size() - first;
+        if (digits <= a.point) {
+            res.insert(first, a.point + 1 - digits, '0');
+        }
+        res.insert(res.size() - a.point, ".");
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& s, big_decimal const& a) {
+    return s << to_string(a);
+}
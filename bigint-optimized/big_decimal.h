@@ -0,0 +1,82 @@
+#ifndef BIG_DECIMAL_H
+#define BIG_DECIMAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "big_integer.h"
+#include "limb_resource.h"
+
+// Fixed-point decimal: an unscaled integer in base 10^9 limbs, least
+// significant first, over 10^scale. Text goes in and out as a straight copy
+// of the digits; conversions to and from big_integer are quadratic.
+// Results that drop digits round half away from zero.
+class big_decimal
+{
+public:
+    static constexpr uint32_t BASE = 1000000000;
+    static constexpr size_t BASE_DIGITS = 9;
+
+    big_decimal();
+    big_decimal(int a);
+    // unscaled / 10^scale
+    explicit big_decimal(big_integer const& unscaled, size_t scale = 0);
+    // "[-]ddd[.ddd]", the scale being the number of digits after the point;
+    // throws std::invalid_argument on anything else
+    explicit big_decimal(std::string const& str);
+
+    size_t scale() const;
+    // adds zeros, or rounds off digits, after the point
+    void rescale(size_t scale);
+    big_integer unscaled() const;
+
+    // sums keep the larger scale of the operands, products add them up
+    big_decimal& operator+=(big_decimal const& rhs);
+    big_decimal& operator-=(big_decimal const& rhs);
+    big_decimal& operator*=(big_decimal const& rhs);
+
+    big_decimal operator+() const;
+    big_decimal operator-() const;
+
+    int sign() const;
+
+    friend int compare(big_decimal const& a, big_decimal const& b);
+    friend std::string to_string(big_decimal const& a);
+
+private:
+    typedef std::vector<uint32_t, limb_allocator<uint32_t>> limbs_t;
+
+    void add(big_decimal const& rhs, bool negate);
+    void trim();
+
+    limbs_t limbs;
+    bool negative;
+    size_t point;
+};
+
+big_decimal operator+(big_decimal a, big_decimal const& b);
+big_decimal operator-(big_decimal a, big_decimal const& b);
+big_decimal operator*(big_decimal a, big_decimal const& b);
+
+// a / b with scale digits after the point; throws std::invalid_argument if
+// b is 0
+big_decimal divide(big_decimal const& a, big_decimal const& b, size_t scale);
+
+// -1, 0 or 1; values compare equal whatever their scales
+int compare(big_decimal const& a, big_decimal const& b);
+
+bool operator==(big_decimal const& a, big_decimal const& b);
+bool operator!=(big_decimal const& a, big_decimal const& b);
+bool operator<(big_decimal const& a, big_decimal const& b);
+bool operator>(big_decimal const& a, big_decimal const& b);
+bool operator<=(big_decimal const& a, big_decimal const& b);
+bool operator>=(big_decimal const& a, big_decimal const& b);
+
+// all scale digits after the point, so "1.50" stays "1.50"
+std::string to_string(big_decimal const& a);
+std::ostream& operator<<(std::ostream& s, big_decimal const& a);
+
+#endif // BIG_DECIMAL_H
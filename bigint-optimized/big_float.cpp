@@ -0,0 +1,420 @@
+#include "big_float.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+
+// extra bits the Newton paths work with, to absorb their truncations
+static const size_t GUARD = 32;
+
+static std::atomic<size_t> default_precision(256);
+static std::atomic<size_t> newton_threshold(8192);
+
+void set_float_precision(size_t bits) {
+    default_precision = std::max<size_t>(bits, 1);
+}
+
+size_t float_precision() {
+    return default_precision;
+}
+
+void set_newton_div_threshold(size_t bits) {
+    // each Newton level works at half the precision plus GUARD bits, which
+    // only shrinks above 2 * GUARD
+    newton_threshold = std::max(bits, 4 * GUARD);
+}
+
+size_t newton_div_threshold() {
+    return newton_threshold;
+}
+
+static size_t bits_of(big_integer const& m) {
+    big_integer_view v(m);
+    v.sign = false;
+    return bit_length(v);
+}
+
+static big_integer from_u64(uint64_t x) {
+    big_integer res(static_cast<unsigned int>(x >> 32));
+    res <<= 32;
+    res += big_integer(static_cast<unsigned int>(x));
+    return res;
+}
+
+static big_float at(big_float x, size_t precision) {
+    x.set_precision(precision);
+    return x;
+}
+
+static big_float one(size_t precision) {
+    return big_float(big_integer(1), 0, precision);
+}
+
+big_float::big_float() : big_float(big_integer(0)) {}
+
+big_float::big_float(int a) : big_float(big_integer(a)) {}
+
+big_float::big_float(big_integer const& mantissa, int64_t exponent, size_t precision) :
+    mant(mantissa),
+    exp(exponent),
+    prec(precision != 0 ? precision : float_precision()) {
+    round();
+}
+
+static big_float parse(std::string const& str, size_t precision) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < str.size() && (str[i] == '-' || str[i] == '+')) {
+        negative = (str[i] == '-');
+        i++;
+    }
+    std::string digits;
+    int64_t scale = 0;
+    bool point = false;
+    for (; i < str.size() && str[i] != 'e' && str[i] != 'E'; i++) {
+        if (str[i] == '.' && !point) {
+            point = true;
+        } else if (str[i] >= '0' && str[i] <= '9') {
+            digits.push_back(str[i]);
+            if (point) {
+                scale--;
+            }
+        } else {
+            throw std::invalid_argument("invalid float");
+        }
+    }
+    if (digits.empty()) {
+        throw std::invalid_argument("invalid float");
+    }
+    if (i < str.size()) {
+        scale += std::stoll(str.substr(i + 1));
+    }
+    big_integer m(digits);
+    m.sign = negative && m != 0;
+    if (scale >= 0) {
+        return big_float(m * pow(big_integer(10), scale), 0, precision);
+    }
+    big_float res = big_float(m, 0, precision + GUARD) / big_float(pow(big_integer(10), -scale), 0, precision + GUARD);
+    res.set_precision(precision);
+    return res;
+}
+
+big_float::big_float(std::string const& str, size_t precision) :
+    big_float(parse(str, precision != 0 ? precision : float_precision())) {}
+
+big_integer const& big_float::mantissa() const {
+    return mant;
+}
+
+int64_t big_float::exponent() const {
+    return exp;
+}
+
+size_t big_float::precision() const {
+    return prec;
+}
+
+void big_float::set_precision(size_t precision) {
+    prec = (precision != 0 ? precision : float_precision());
+    round();
+}
+
+void big_float::round() {
+    size_t n = bits_of(mant);
+    if (n > prec) {
+        // shift the magnitude, since >> on a negative mantissa would floor
+        bool s = mant.sign;
+        mant.sign = false;
+        mant >>= static_cast<int>(n - prec);
+        mant.sign = s;
+        exp += static_cast<int64_t>(n - prec);
+    }
+    if (mant == 0) {
+        exp = 0;
+    }
+}
+
+big_float& big_float::operator+=(big_float const& rhs) {
+    if (this == &rhs) {
+        big_float copy = rhs;
+        return *this += copy;
+    }
+    prec = std::max(prec, rhs.prec);
+    if (rhs.mant == 0) {
+        round();
+        return *this;
+    }
+    if (mant == 0) {
+        mant = rhs.mant;
+        exp = rhs.exp;
+        round();
+        return *this;
+    }
+    // an operand wholly below the last kept bit of the other one is lost to
+    // the truncation anyway, so it is not aligned at all
+    int64_t top = exp + static_cast<int64_t>(bits_of(mant));
+    int64_t rhs_top = rhs.exp + static_cast<int64_t>(bits_of(rhs.mant));
+    int64_t span = static_cast<int64_t>(prec) + 1;
+    if (top > rhs_top + span) {
+        round();
+        return *this;
+    }
+    if (rhs_top > top + span) {
+        mant = rhs.mant;
+        exp = rhs.exp;
+        round();
+        return *this;
+    }
+    if (exp > rhs.exp) {
+        mant <<= static_cast<int>(exp - rhs.exp);
+        exp = rhs.exp;
+        mant += rhs.mant;
+    } else if (exp < rhs.exp) {
+        mant += rhs.mant << static_cast<int>(rhs.exp - exp);
+    } else {
+        mant += rhs.mant;
+    }
+    round();
+    return *this;
+}
+
+big_float& big_float::operator-=(big_float const& rhs) {
+    return *this += -rhs;
+}
+
+big_float& big_float::operator*=(big_float const& rhs) {
+    mant *= rhs.mant;
+    exp += rhs.exp;
+    prec = std::max(prec, rhs.prec);
+    round();
+    return *this;
+}
+
+// a / b exactly truncated, by long division of the mantissas
+static big_float long_div(big_float const& a, big_float const& b, size_t p) {
+    size_t na = bits_of(a.mantissa()), nb = bits_of(b.mantissa());
+    // enough bits that the quotient has more than p of them
+    size_t s = (p + 1 + nb > na ? p + 1 + nb - na : 0);
+    big_integer q = (a.mantissa() << static_cast<int>(s)) / b.mantissa();
+    return big_float(q, a.exponent() - b.exponent() - static_cast<int64_t>(s), p);
+}
+
+// 1 / b to about p bits: y += y * (1 - b * y) doubles the correct bits of a
+// half-precision estimate, so the whole costs a few multiplications at p
+static big_float reciprocal(big_float const& b, size_t p) {
+    if (p < newton_div_threshold()) {
+        return long_div(one(p), b, p);
+    }
+    big_float y = reciprocal(b, p / 2 + GUARD);
+    y.set_precision(p);
+    big_float e = one(p) - at(b, p) * y;
+    y += y * e;
+    return y;
+}
+
+big_float& big_float::operator/=(big_float const& rhs) {
+    if (rhs.mant == 0) {
+        throw std::invalid_argument("Division by zero!");
+    }
+    size_t p = std::max(prec, rhs.prec);
+    if (p < newton_div_threshold()) {
+        return *this = long_div(*this, rhs, p);
+    }
+    *this = at(*this, p + GUARD) * reciprocal(rhs, p + GUARD);
+    set_precision(p);
+    return *this;
+}
+
+big_float big_float::operator+() const {
+    return *this;
+}
+
+big_float big_float::operator-() const {
+    big_float r = *this;
+    r.mant = -r.mant;
+    return r;
+}
+
+int big_float::sign() const {
+    if (mant == 0) {
+        return 0;
+    }
+    return mant.sign ? -1 : 1;
+}
+
+big_float operator+(big_float a, big_float const& b) {
+    return a += b;
+}
+
+big_float operator-(big_float a, big_float const& b) {
+    return a -= b;
+}
+
+big_float operator*(big_float a, big_float const& b) {
+    return a *= b;
+}
+
+big_float operator/(big_float a, big_float const& b) {
+    return a /= b;
+}
+
+// 1 / sqrt(a) to the 53 bits of a double, a > 0
+static big_float rsqrt_seed(big_float const& a) {
+    big_integer const& m = a.mantissa();
+    size_t n = bits_of(m);
+    big_integer top = (n > 53 ? m >> static_cast<int>(n - 53) : m << static_cast<int>(53 - n));
+    int64_t e = a.exponent() + static_cast<int64_t>(n) - 53;
+    uint64_t t = 0;
+    for (size_t i = top.num.size(); i-- > 0;) {
+        t = (t << 32) | top.num[i];
+    }
+    double d = static_cast<double>(t);
+    if (e % 2 != 0) {
+        d *= 2;
+        e--;
+    }
+    int y_exp;
+    double f = std::frexp(1 / std::sqrt(d), &y_exp);
+    return big_float(from_u64(static_cast<uint64_t>(std::ldexp(f, 53))), y_exp - 53 - e / 2, 53);
+}
+
+// y += y * (1 - a * y^2) / 2, doubling the correct bits like reciprocal
+static big_float rsqrt(big_float const& a, size_t p) {
+    if (p <= 48) {
+        return rsqrt_seed(a);
+    }
+    big_float y = rsqrt(a, p / 2 + 16);
+    y.set_precision(p);
+    big_float e = one(p) - at(a, p) * y * y;
+    y += y * e * big_float(big_integer(1), -1, p);
+    return y;
+}
+
+big_float sqrt(big_float const& a) {
+    if (a.sign() < 0) {
+        throw std::invalid_argument("sqrt of a negative number");
+    }
+    if (a.sign() == 0) {
+        return a;
+    }
+    size_t p = a.precision();
+    big_float res = at(a, p + GUARD) * rsqrt(a, p + GUARD);
+    res.set_precision(p);
+    return res;
+}
+
+big_integer trunc(big_float const& a) {
+    big_integer const& m = a.mantissa();
+    int64_t e = a.exponent();
+    if (e >= 0) {
+        return m << static_cast<int>(e);
+    }
+    if (static_cast<uint64_t>(-e) >= bits_of(m)) {
+        return 0;
+    }
+    big_integer res = m;
+    res.sign = false;
+    res >>= static_cast<int>(-e);
+    res.sign = m.sign;
+    res.remFrontZero();
+    return res;
+}
+
+int compare(big_float const& a, big_float const& b) {
+    int sa = a.sign(), sb = b.sign();
+    if (sa != sb || sa == 0) {
+        return sa < sb ? -1 : (sa > sb ? 1 : 0);
+    }
+    int64_t ta = a.exp + static_cast<int64_t>(bits_of(a.mant));
+    int64_t tb = b.exp + static_cast<int64_t>(bits_of(b.mant));
+    if (ta != tb) {
+        return (ta > tb) == (sa > 0) ? 1 : -1;
+    }
+    // same leading bit, so the exponents differ by at most the precision
+    int res;
+    if (a.exp > b.exp) {
+        big_integer x = a.mant << static_cast<int>(a.exp - b.exp);
+        res = (x < b.mant ? -1 : (x == b.mant ? 0 : 1));
+    } else {
+        big_integer y = b.mant << static_cast<int>(b.exp - a.exp);
+        res = (a.mant < y ? -1 : (a.mant == y ? 0 : 1));
+    }
+    return res;
+}
+
+bool operator==(big_float const& a, big_float const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_float const& a, big_float const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_float const& a, big_float const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_float const& a, big_float const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_float const& a, big_float const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_float const& a, big_float const& b) {
+    return compare(a, b) >= 0;
+}
+
+std::string to_string(big_float const& a, size_t digits) {
+    if (a.sign() == 0) {
+        return "0";
+    }
+    digits = std::max<size_t>(digits, 1);
+    big_integer m = a.mantissa();
+    m.sign = false;
+    int64_t e = a.exponent();
+    // the decimal exponent from the binary one may be one too small or large
+    int64_t e10 = static_cast<int64_t>(std::floor((e + static_cast<int64_t>(bits_of(m)) - 1) * 0.30102999566398119521));
+    std::string s;
+    while (true) {
+        int64_t k = static_cast<int64_t>(digits) - 1 - e10;
+        big_integer n = m;
+        if (k > 0) {
+            n *= pow(big_integer(10), k);
+        }
+        // n = floor(2 * |a| * 10^k), then rounded half up to |a| * 10^k
+        if (e >= -1) {
+            n <<= static_cast<int>(e + 1);
+        } else {
+            n >>= static_cast<int>(std::min<int64_t>(-e - 1, bits_of(n)));
+        }
+        if (k < 0) {
+            n /= pow(big_integer(10), -k);
+        }
+        n += 1;
+        n >>= 1;
+        s = to_string(n);
+        if (s.size() == digits) {
+            break;
+        }
+        e10 += (s.size() > digits ? 1 : -1);
+    }
+    if (digits > 1) {
+        s.insert(1, ".");
+    }
+    if (e10 != 0) {
+        s += "e" + std::to_string(e10);
+    }
+    return (a.sign() < 0 ? "-" : "") + s;
+}
+
+std::string to_string(big_float const& a) {
+    return to_string(a, static_cast<size_t>(a.precision() * 0.30102999566398119521));
+}
+
+std::ostream& operator<<(std::ostream& s, big_float const& a) {
+    return s << to_string(a);
+}
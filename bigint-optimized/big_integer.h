@@ -6,9 +6,12 @@
 #include <iosfwd>
 #include <vector>
 #include <cstdint>
+#include <functional>
 
 #include "my_vector.h"
 
+struct big_integer_view;
+
 struct big_integer
 {
     // std::vector<unsigned int> num;
@@ -20,15 +23,21 @@ struct big_integer
     big_integer(int a);
     big_integer(unsigned int a);
     explicit big_integer(std::string const& str);
+    explicit big_integer(big_integer_view v);
     ~big_integer();
 
     big_integer& operator=(big_integer const& other);
 
     big_integer& operator+=(big_integer const& rhs);
+    big_integer& operator+=(big_integer_view rhs);
     big_integer& operator-=(big_integer const& rhs);
+    big_integer& operator-=(big_integer_view rhs);
     big_integer& operator*=(big_integer const& rhs);
+    big_integer& operator*=(big_integer_view rhs);
     big_integer& operator/=(big_integer const& rhs);
+    big_integer& operator/=(big_integer_view rhs);
     big_integer& operator%=(big_integer const& rhs);
+    big_integer& operator%=(big_integer_view rhs);
 
     big_integer& operator&=(big_integer const& rhs);
     big_integer& operator|=(big_integer const& rhs);
@@ -58,6 +67,21 @@ struct big_integer
     void remFrontZero();
 };
 
+// Read-only limbs owned by someone else (a network buffer, an mmap'd file,
+// another big_integer), least significant first. The memory must outlive
+// the view. Leading zero limbs are trimmed on construction.
+struct big_integer_view
+{
+    uint32_t const* num;
+    size_t len;
+    bool sign;
+
+    big_integer_view(uint32_t const* num, size_t len, bool sign = false);
+    big_integer_view(big_integer const& a);
+
+    big_integer_view operator-() const;
+};
+
 big_integer operator+(big_integer a, big_integer const& b);
 big_integer operator-(big_integer a, big_integer const& b);
 big_integer operator*(big_integer a, big_integer const& b);
@@ -71,6 +95,58 @@ big_integer operator^(big_integer a, big_integer const& b);
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
+big_integer pow(big_integer const& a, uint64_t e);
+// greatest common divisor of |a| and |b|, 0 for gcd(0, 0)
+big_integer gcd(big_integer_view a, big_integer_view b);
+// x in [0, |m|) with a * x = 1 mod m; throws std::invalid_argument if
+// |m| <= 1 or gcd(a, m) != 1
+big_integer invmod(big_integer_view a, big_integer_view m);
+// a / b for a b known to divide a, faster than / as nothing is estimated or
+// corrected; anything else gives a meaningless result
+big_integer divexact(big_integer_view a, big_integer_view b);
+
+// Bits of the infinite two's-complement form the bitwise operators work on,
+// so -1 has every bit set. bit_length counts the bits below the sign bit and
+// popcount the bits that differ from it; both are 0 for 0 and -1.
+size_t bit_length(big_integer_view a);
+bool test_bit(big_integer_view a, size_t k);
+size_t popcount(big_integer_view a);
+// index of the lowest set bit; throws std::invalid_argument for 0
+size_t count_trailing_zeros(big_integer_view a);
+// a & -a, that is 2^count_trailing_zeros(a), or 0 for 0
+big_integer lowest_set_bit(big_integer_view a);
+// a |= 1 << k, a &= ~(1 << k) and a ^= 1 << k in place
+big_integer& set_bit(big_integer& a, size_t k);
+big_integer& clear_bit(big_integer& a, size_t k);
+big_integer& flip_bit(big_integer& a, size_t k);
+
+// Threads that big multiplications are split across, 1 for none; defaults
+// to the hardware thread count. Schoolbook products are split into slices
+// of at least parallel_mul_cutoff() limbs of the shorter operand, and the
+// three Karatsuba sub-products run as separate tasks.
+void set_mul_threads(size_t threads);
+size_t mul_threads();
+void set_parallel_mul_cutoff(size_t limbs);
+size_t parallel_mul_cutoff();
+
+// Non-mutating operations straight on the viewed limbs; only the result is
+// allocated. Division still copies both operands to normalise them.
+big_integer operator+(big_integer_view a, big_integer_view b);
+big_integer operator-(big_integer_view a, big_integer_view b);
+big_integer operator*(big_integer_view a, big_integer_view b);
+big_integer operator/(big_integer_view a, big_integer_view b);
+big_integer operator%(big_integer_view a, big_integer_view b);
+
+bool operator==(big_integer_view a, big_integer_view b);
+bool operator!=(big_integer_view a, big_integer_view b);
+bool operator<(big_integer_view a, big_integer_view b);
+bool operator>(big_integer_view a, big_integer_view b);
+bool operator<=(big_integer_view a, big_integer_view b);
+bool operator>=(big_integer_view a, big_integer_view b);
+
+std::string to_string(big_integer_view a);
+std::ostream& operator<<(std::ostream& s, big_integer_view a);
+
 bool operator==(big_integer const& a, big_integer const& b);
 bool operator!=(big_integer const& a, big_integer const& b);
 bool operator<(big_integer const& a, big_integer const& b);
@@ -81,4 +157,26 @@ bool operator>=(big_integer const& a, big_integer const& b);
 std::string to_string(big_integer const& a);
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
 
+// Binary format: a little-endian uint32_t header holding the limb count with
+// the sign in the top bit, followed by the limbs, least significant first.
+size_t serialized_size(big_integer const& a);
+void serialize(big_integer const& a, std::vector<uint8_t>& out);
+// reads the value at in[pos] and moves pos past it
+big_integer deserialize(std::vector<uint8_t> const& in, size_t& pos);
+
+// Compact format for small values: LEB128 of (magnitude << 1 | sign).
+void serialize_varint(big_integer const& a, std::vector<uint8_t>& out);
+big_integer deserialize_varint(std::vector<uint8_t> const& in, size_t& pos);
+
+// Many values back to back in one buffer, in the binary format above.
+std::vector<uint8_t> serialize_all(std::vector<big_integer> const& values);
+std::vector<big_integer> deserialize_all(std::vector<uint8_t> const& in);
+
+namespace std {
+template<>
+struct hash<big_integer> {
+    size_t operator()(big_integer const& a) const;
+};
+}
+
 #endif // BIG_INTEGER_H
@@ -26,6 +26,35 @@ big_integer_gmp::~big_integer_gmp() {
   mpz_clear(mpz);
 }
 
+namespace {
+struct random_state {
+  gmp_randstate_t state;
+
+  random_state() {
+    gmp_randinit_mt(state);
+  }
+
+  ~random_state() {
+    gmp_randclear(state);
+  }
+};
+}
+
+// Reseeding on every call keeps each value a function of the caller's
+// engine alone, as it was with a fresh state per call; only the
+// initialisation is shared.
+big_integer_gmp& big_integer_gmp::urandom(size_t sz, unsigned long seed) {
+  static thread_local random_state rs;
+  gmp_randseed_ui(rs.state, seed);
+  mpz_urandomb(mpz, rs.state, sz + 1);
+  mpz_t shift;
+  mpz_init(shift);
+  mpz_setbit(shift, sz);
+  mpz_sub(mpz, mpz, shift);
+  mpz_clear(shift);
+  return *this;
+}
+
 big_integer_gmp& big_integer_gmp::operator=(big_integer_gmp const& other) {
   mpz_set(mpz, other.mpz);
   return *this;
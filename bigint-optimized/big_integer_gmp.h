@@ -11,17 +11,11 @@ struct big_integer_gmp {
   big_integer_gmp(int a);
   explicit big_integer_gmp(std::string const& str);
 
+  // uniform in [-2^sz, 2^sz), seeded from one rng() per call; the Mersenne
+  // Twister state is allocated once per thread and reseeded each time
   template<typename RNG>
   big_integer_gmp& random(size_t sz, RNG&& rng) {
-    gmp_randstate_t state;
-    gmp_randinit_mt(state);
-    gmp_randseed_ui(state, rng());
-    mpz_urandomb(mpz, state, sz + 1);
-    gmp_randclear(state);
-    big_integer_gmp shift(1);
-    shift <<= sz;
-    *this -= shift;
-    return *this;
+    return urandom(sz, static_cast<unsigned long>(rng()));
   }
 
   ~big_integer_gmp();
@@ -61,6 +55,8 @@ struct big_integer_gmp {
   friend std::string to_string(big_integer_gmp const& a);
 
  private:
+  big_integer_gmp& urandom(size_t sz, unsigned long seed);
+
   mpz_t mpz;
 };
 
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <unordered_set>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 #include <random>
 #include <vector>
@@ -8,6 +10,21 @@
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "big_uint.h"
+#include "big_literal.h"
+#include "limb_kernels.h"
+#include "mapped_limbs.h"
+#include "scratch_arena.h"
+#include "limb_resource.h"
+#include "task_pool.h"
+#include "big_batch.h"
+#include "big_random.h"
+#include "big_rational.h"
+#include "big_float.h"
+#include "binary_splitting.h"
+#include "big_decimal.h"
+#include "mod_int.h"
+#include "rns.h"
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -666,15 +683,9 @@ TEST(correctness, mul_merge_randomized) {
 }
 
 namespace {
+// about as wide as size + 1 calls to rand() would give
 big_integer rand_big(size_t size) {
-  big_integer result = rand();
-
-  for (size_t i = 0; i != size; ++i) {
-    result *= RAND_MAX;
-    result += rand();
-  }
-
-  return result;
+  return big_random::local().bits(31 * (size + 1));
 }
 }
 
@@ -835,3 +846,927 @@ TEST(correctness_twos_complement, all_ones) {
 
   EXPECT_EQ(to_string(gmp_ans), to_string(your_ans));
 }
+
+TEST(correctness, pow_small) {
+  EXPECT_EQ(1, pow(big_integer(0), 0));
+  EXPECT_EQ(0, pow(big_integer(0), 5));
+  EXPECT_EQ(1, pow(big_integer(-1), 4));
+  EXPECT_EQ(-1, pow(big_integer(-1), 7));
+  EXPECT_EQ(1024, pow(big_integer(2), 10));
+  EXPECT_EQ(-2187, pow(big_integer(-3), 7));
+  EXPECT_EQ(big_integer("1000000000000000000000000000000"), pow(big_integer(10), 30));
+  EXPECT_EQ(big_integer(1) << 3000, pow(big_integer(8), 1000));
+  EXPECT_EQ(-(big_integer(1) << 96), pow(big_integer(-(big_integer(1) << 32)), 3));
+}
+
+TEST(correctness, pow_randomized) {
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer base = rand_big(3);
+    if (rand() % 2) {
+      base = -base;
+    }
+    uint64_t e = rand() % 300;
+    big_integer expected = 1;
+    for (uint64_t i = 0; i != e; ++i) {
+      expected *= base;
+    }
+    EXPECT_EQ(expected, pow(base, e));
+  }
+}
+
+TEST(correctness, fixed_width) {
+  static_assert(big_uint<256>(6) * big_uint<256>(7) == big_uint<256>(42), "constexpr arithmetic");
+  static_assert((big_int<256>(-1) >> 100) == -1, "arithmetic shift");
+
+  big_uint<256> max = big_uint<256>(0) - 1;
+  EXPECT_EQ(0, max + 1);
+  EXPECT_EQ("115792089237316195423570985008687907853269984665640564039457584007913129639935", to_string(max));
+  EXPECT_EQ(max, big_uint<256>(-1));
+  EXPECT_EQ(max >> 255, 1);
+  EXPECT_EQ(big_integer(1) << 255, static_cast<big_integer>(big_uint<256>(1) << 255));
+
+  big_int<512> a("-1000000000000000000000000000000000000007");
+  big_int<512> b("998244353");
+  EXPECT_EQ("-1000000000000000000000000000000000000007", to_string(a));
+  EXPECT_LT(a, b);
+  EXPECT_EQ(big_integer("-1001758734717330276748382467433"), static_cast<big_integer>(a / b));
+  EXPECT_EQ(big_integer("-801344158"), static_cast<big_integer>(a % b));
+  EXPECT_EQ(a, big_int<512>(static_cast<big_integer>(a)));
+}
+
+TEST(correctness_random, fixed_width) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(240, rng);
+    b.random(120, rng);
+    big_integer A = big_integer(to_string(a));
+    big_integer B = big_integer(to_string(b));
+    big_int<512> fa(A), fb(B);
+    int shift = rand() % 256;
+
+    EXPECT_EQ(to_string(A + B), to_string(fa + fb));
+    EXPECT_EQ(to_string(A - B), to_string(fa - fb));
+    EXPECT_EQ(to_string(A * B), to_string(fa * fb));
+    EXPECT_EQ(to_string(A / B), to_string(fa / fb));
+    EXPECT_EQ(to_string(A % B), to_string(fa % fb));
+    EXPECT_EQ(to_string(B / A), to_string(fb / fa));
+    EXPECT_EQ(to_string(A & B), to_string(fa & fb));
+    EXPECT_EQ(to_string(A | B), to_string(fa | fb));
+    EXPECT_EQ(to_string(A ^ B), to_string(fa ^ fb));
+    EXPECT_EQ(to_string(~A), to_string(~fa));
+    EXPECT_EQ(to_string(A << shift), to_string(fa << shift));
+    EXPECT_EQ(to_string(A >> shift), to_string(fa >> shift));
+    EXPECT_EQ(A < B, fa < fb);
+
+    big_integer mask = (big_integer(1) << 256) - 1;
+    big_uint<256> ua(A), ub(B);
+    EXPECT_EQ((A * B) & mask, static_cast<big_integer>(ua * ub));
+    EXPECT_EQ((A - B) & mask, static_cast<big_integer>(ua - ub));
+  }
+}
+
+TEST(correctness, literals) {
+  big_integer a = 123456789012345678901234567890_bi;
+  EXPECT_EQ(big_integer("123456789012345678901234567890"), a);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890"), -123456789012345678901234567890_bi);
+  EXPECT_EQ(0, 0_bi);
+  EXPECT_EQ(0, -0_bi);
+  EXPECT_EQ(1000000, 1'000'000_bi);
+  EXPECT_EQ(big_integer(1) << 100, 0x10000000000000000000000000_bi);
+  EXPECT_EQ(big_integer(1) << 64, 0b10000000000000000000000000000000000000000000000000000000000000000_bi);
+  EXPECT_EQ(a * 2, a + 123456789012345678901234567890_bi);
+
+  constexpr big_uint<256> p = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF_bi;
+  static_assert(p % 2 == 1, "constexpr literal");
+  constexpr big_int<128> m = -170141183460469231731687303715884105728_bi;
+  static_assert(m < 0 && m - 1 > 0, "constexpr literal");
+  EXPECT_EQ(big_integer("115792089210356248762697446949407573530086143415290314195533631308867097853951"),
+            static_cast<big_integer>(p));
+}
+
+TEST(correctness_random, limb_tiers) {
+  limb_tier initial = active_limb_tier();
+  for (limb_tier tier : {limb_tier::generic, limb_tier::adx, limb_tier::avx2, limb_tier::avx512}) {
+    if (!set_limb_tier(tier)) {
+      continue;
+    }
+    std::default_random_engine rng(42);
+    for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+      big_integer_gmp a, b;
+      a.random(max_size + itn, rng);
+      b.random(max_size / 2 + itn * 33, rng);
+      big_integer A = big_integer(to_string(a));
+      big_integer B = big_integer(to_string(b));
+      EXPECT_EQ(to_string(a + b), to_string(A + B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a - b), to_string(A - B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a * b), to_string(A * B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a / b), to_string(A / B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a & b), to_string(A & B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a | b), to_string(A | B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(a ^ b), to_string(A ^ B)) << limb_tier_name(tier);
+      EXPECT_EQ(to_string(~a), to_string(~A)) << limb_tier_name(tier);
+      EXPECT_EQ(a < b, A < B) << limb_tier_name(tier);
+      EXPECT_EQ(a == a + 1, A == A + 1) << limb_tier_name(tier);
+      EXPECT_EQ(A < ((A >> 300) << 300), a < ((a >> 300) << 300)) << limb_tier_name(tier);
+    }
+  }
+  set_limb_tier(initial);
+}
+
+TEST(correctness, hash) {
+  std::hash<big_integer> h;
+  big_integer a("123456789012345678901234567890");
+  big_integer b = a;
+  big_integer c = (a * 7 + 3 - 3) / 7;
+  EXPECT_EQ(h(a), h(b));
+  EXPECT_EQ(h(a), h(c));
+  EXPECT_NE(h(a), h(-a));
+  EXPECT_EQ(h(big_integer(0)), h(-big_integer(0)));
+  b += 1;
+  EXPECT_NE(h(a), h(b));
+  b -= 1;
+  EXPECT_EQ(h(a), h(b));
+  if (sizeof(size_t) == 8) {
+    // pinned so that bigint and bigint-optimized agree
+    EXPECT_EQ(13381976726041825732ull, h(a));
+    EXPECT_EQ(5806882928802977445ull, h(big_integer(-5) << 1000));
+  }
+
+  std::unordered_set<big_integer> set;
+  for (int i = -500; i != 500; ++i) {
+    set.insert(big_integer(i) << 100);
+    set.insert(big_integer(i) << 100);
+  }
+  EXPECT_EQ(1000u, set.size());
+  EXPECT_EQ(1u, set.count(big_integer(-7) << 100));
+  EXPECT_EQ(0u, set.count(big_integer(-7) << 99));
+}
+
+TEST(correctness, serialization) {
+  std::vector<big_integer> values = {0, 1, -1, 127, -64, 63, std::numeric_limits<int>::min(),
+                                     big_integer("-340282366920938463463374607431768211456"),
+                                     big_integer("123456789012345678901234567890123456789")};
+  for (int i = 0; i != 20; ++i) {
+    values.push_back(rand_big(i) * (i % 2 ? -1 : 1));
+  }
+
+  std::vector<uint8_t> buf = serialize_all(values);
+  size_t expected_size = 0;
+  for (big_integer const& v : values) {
+    expected_size += serialized_size(v);
+  }
+  EXPECT_EQ(expected_size, buf.size());
+  EXPECT_EQ(values, deserialize_all(buf));
+
+  std::vector<uint8_t> var;
+  for (big_integer const& v : values) {
+    serialize_varint(v, var);
+  }
+  size_t pos = 0;
+  for (big_integer const& v : values) {
+    EXPECT_EQ(v, deserialize_varint(var, pos));
+  }
+  EXPECT_EQ(var.size(), pos);
+
+  std::vector<uint8_t> small;
+  serialize_varint(63, small);
+  serialize_varint(-64, small);
+  EXPECT_EQ(3u, small.size());
+
+  buf.pop_back();
+  EXPECT_THROW(deserialize_all(buf), std::invalid_argument);
+}
+
+TEST(correctness, view) {
+  uint32_t limbs[] = {1, 2, 3, 0, 0};
+  big_integer_view v(limbs, 5);
+  big_integer_view w(limbs, 2, true);
+  big_integer expected_v = (big_integer(3) << 64) + (big_integer(2) << 32) + 1;
+  big_integer expected_w = -((big_integer(2) << 32) + 1);
+
+  EXPECT_EQ(3u, v.len);
+  EXPECT_EQ(expected_v, big_integer(v));
+  EXPECT_TRUE(v == expected_v);
+  EXPECT_TRUE(expected_w == w);
+  EXPECT_TRUE(w < v);
+  EXPECT_TRUE(-v < w);
+  EXPECT_TRUE(big_integer_view(limbs + 3, 2, true) == big_integer_view(nullptr, 0));
+
+  EXPECT_EQ(expected_v + expected_w, v + w);
+  EXPECT_EQ(expected_v - expected_w, v - w);
+  EXPECT_EQ(expected_v * expected_w, v * w);
+  EXPECT_EQ(expected_v / expected_w, v / w);
+  EXPECT_EQ(expected_v % expected_w, v % w);
+  EXPECT_EQ(to_string(expected_w), to_string(w));
+
+  big_integer acc = 5;
+  acc += v;
+  acc *= w;
+  acc -= w;
+  EXPECT_EQ((5 + expected_v) * expected_w - expected_w, acc);
+
+  for (int i = 0; i != 20; ++i) {
+    big_integer a = rand_big(i * 7) * (i % 2 ? -1 : 1);
+    big_integer b = rand_big(i * 3 + 1) * (i % 3 ? 1 : -1);
+    big_integer_view va(a), vb(b);
+    EXPECT_EQ(a + b, va + vb);
+    EXPECT_EQ(a - b, va - vb);
+    EXPECT_EQ(a * b, va * vb);
+    EXPECT_EQ(a / b, va / vb);
+    EXPECT_EQ(a % b, va % vb);
+    EXPECT_EQ(a < b, va < vb);
+  }
+
+  big_integer self = expected_v;
+  self += self;
+  self -= big_integer_view(self);
+  EXPECT_EQ(0, self);
+}
+
+TEST(correctness, mapped_limbs) {
+  std::string prefix = "big_integer_testing_" + std::to_string(myrand()) + "_";
+  big_integer x = rand_big(3000);
+  big_integer y = rand_big(1700);
+  x.sign = y.sign = false;
+  {
+    mapped_limbs a(prefix + "a", 0), b(prefix + "b", 0), res(prefix + "res", 0);
+    a.assign(x);
+    b.assign(y);
+    EXPECT_EQ(x, big_integer(a.view()));
+
+    stream_add(res, a, b, 64);
+    EXPECT_EQ(x + y, big_integer(res.view()));
+    stream_add(res, b, a, 1000);
+    EXPECT_EQ(x + y, big_integer(res.view()));
+
+    stream_mul(res, a, b, 200);
+    EXPECT_EQ(x * y, big_integer(res.view()));
+
+    // interrupt after a few blocks and resume from the last checkpoint
+    stream_checkpoint saved;
+    try {
+      stream_mul(res, b, a, 128, [&saved](stream_checkpoint const& done, size_t) {
+        saved = done;
+        if (done.block == 3) {
+          throw std::runtime_error("interrupted");
+        }
+      });
+    } catch (std::runtime_error const&) {
+    }
+    EXPECT_EQ(3u, saved.block);
+    size_t calls = 0;
+    stream_mul(res, b, a, 128, [&calls](stream_checkpoint const&, size_t) { calls++; }, saved);
+    EXPECT_EQ(x * y, big_integer(res.view()));
+    EXPECT_EQ((x.num.size() + y.num.size() + 127) / 128 - 3, calls);
+
+    // a crash in the middle of block 5 leaves it half written
+    try {
+      stream_mul(res, a, b, 128, [&saved](stream_checkpoint const& done, size_t) {
+        if (done.block == 5) {
+          throw std::runtime_error("interrupted");
+        }
+        saved = done;
+      });
+    } catch (std::runtime_error const&) {
+    }
+    EXPECT_EQ(4u, saved.block);
+    std::fill(res.data() + 4 * 128, res.data() + 4 * 128 + 100, 0xdeadbeef);
+    stream_mul(res, a, b, 128, stream_hook(), saved);
+    EXPECT_EQ(x * y, big_integer(res.view()));
+
+    try {
+      stream_add(res, a, b, 100, [&saved](stream_checkpoint const& done, size_t) {
+        saved = done;
+        if (done.block == 7) {
+          throw std::runtime_error("interrupted");
+        }
+      });
+    } catch (std::runtime_error const&) {
+    }
+    stream_add(res, a, b, 100, stream_hook(), saved);
+    EXPECT_EQ(x + y, big_integer(res.view()));
+  }
+  std::remove((prefix + "a").c_str());
+  std::remove((prefix + "b").c_str());
+  std::remove((prefix + "res").c_str());
+}
+
+TEST(correctness, scratch_arena) {
+  scratch_arena& arena = scratch_arena::local();
+  size_t before = arena.used();
+  {
+    scratch_limbs a(10);
+    scratch_limbs b(5000);
+    scratch_limbs c(3);
+    a[9] = 1;
+    b[4999] = 2;
+    c[2] = 3;
+    EXPECT_EQ(before + 5013, arena.used());
+    EXPECT_EQ(1u, a[9]);
+    EXPECT_EQ(2u, b[4999]);
+  }
+  EXPECT_EQ(before, arena.used());
+
+  scratch_reserve(20000);
+  size_t capacity = scratch_capacity();
+  EXPECT_LE(20000u, capacity);
+  big_integer x = rand_big(3000), y = rand_big(1000);
+  for (int i = 0; i != 10; ++i) {
+    big_integer q = x / y, r = x % y;
+    EXPECT_EQ(x, q * y + r);
+    EXPECT_EQ(x, (x & y) + (x & ~y));
+    x *= -1;
+  }
+  EXPECT_EQ(capacity, scratch_capacity());
+
+  scratch_trim();
+  EXPECT_EQ(0u, scratch_capacity());
+}
+
+namespace {
+struct counting_resource : std::pmr::memory_resource {
+  size_t allocated = 0;
+  size_t live = 0;
+
+  void* do_allocate(size_t bytes, size_t align) override {
+    allocated += bytes;
+    live++;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t align) override {
+    live--;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+    return this == &other;
+  }
+};
+}
+
+TEST(correctness, limb_resource) {
+  counting_resource counter;
+  big_integer x = rand_big(100), y = rand_big(60);
+  big_integer product = x * y, quotient = x / y;
+  {
+    limb_resource_scope scope(&counter);
+    EXPECT_EQ(&counter, limb_resource());
+    big_integer a = x, b = y;
+    EXPECT_EQ(product, a * b);
+    EXPECT_EQ(quotient, a / b);
+    EXPECT_LT(0u, counter.allocated);
+  }
+  EXPECT_EQ(0u, counter.live);
+  EXPECT_EQ(std::pmr::new_delete_resource(), limb_resource());
+
+  size_t allocated = counter.allocated;
+  big_integer z = x * y;
+  EXPECT_EQ(allocated, counter.allocated);
+
+  // a request pool: everything allocated while it is current goes with it
+  std::pmr::monotonic_buffer_resource pool(&counter);
+  {
+    limb_resource_scope scope(&pool);
+    big_integer acc = 1;
+    for (int i = 0; i != 50; ++i) {
+      acc *= x;
+      acc %= z;
+    }
+    EXPECT_EQ(pow(x, 50) % z, acc);
+  }
+  EXPECT_LT(allocated, counter.allocated);
+  pool.release();
+  EXPECT_EQ(0u, counter.live);
+}
+
+TEST(correctness, parallel_mul) {
+  big_integer a = rand_big(2000), b = rand_big(3500) * -1;
+  size_t threads = mul_threads();
+  set_mul_threads(1);
+  big_integer expected = a * b;
+  big_integer expected_sqr = pow(a, 3);
+
+  size_t cutoff = parallel_mul_cutoff();
+  set_mul_threads(4);
+  EXPECT_EQ(4u, mul_threads());
+  set_parallel_mul_cutoff(7);
+  EXPECT_EQ(expected, a * b);
+  EXPECT_EQ(expected, b * a);
+  EXPECT_EQ(expected_sqr, pow(a, 3));
+  big_integer c = a;
+  c *= b;
+  EXPECT_EQ(expected, c);
+
+  std::atomic<int> sum(0);
+  task_pool::global().run(10, [&sum](size_t i) {
+    task_pool::global().run(5, [&sum, i](size_t j) { sum += static_cast<int>(i * j); });
+  });
+  EXPECT_EQ(450, sum);
+  EXPECT_THROW(task_pool::global().run(3, [](size_t i) {
+    if (i == 1) {
+      throw std::runtime_error("task");
+    }
+  }), std::runtime_error);
+
+  set_parallel_mul_cutoff(cutoff);
+  set_mul_threads(threads);
+}
+
+TEST(correctness, batch) {
+  size_t const count = 600, limbs = 4;
+  std::vector<big_integer> xs, ys;
+  big_integer mod = big_integer(1) << (32 * limbs);
+  for (size_t i = 0; i != count; ++i) {
+    big_integer x = rand_big(4 + i % 5) % mod, y = rand_big(1 + i % 5) % mod;
+    x.sign = y.sign = false;
+    xs.push_back(x);
+    ys.push_back(y);
+  }
+  xs[0] = mod - 1;
+  ys[0] = mod - 1;
+  ys[1] = 0;
+  big_batch a(xs, limbs), b(ys, limbs);
+  EXPECT_EQ(xs, a.to_vector());
+
+  big_batch sum(count, limbs + 1), wrapped(count, limbs), product(count, 2 * limbs);
+  big_batch m1(count, limbs), m2(count, 1), m3(count, 3);
+  big_integer p1("340282366920938463463374607431768211297");
+  big_integer p2 = 4294967291u;
+  big_integer p3 = big_integer(1) << 64;
+  limb_tier initial = active_limb_tier();
+  for (limb_tier tier : {limb_tier::generic, limb_tier::avx2, limb_tier::avx512}) {
+    if (!set_limb_tier(tier)) {
+      continue;
+    }
+    batch_add(sum, a, b);
+    batch_add(wrapped, a, b);
+    batch_mul(product, a, b);
+    batch_mod(m1, product, p1);
+    batch_mod(m2, product, p2);
+    batch_mod(m3, product, p3);
+    for (size_t i = 0; i != count; ++i) {
+      big_integer p = xs[i] * ys[i];
+      EXPECT_EQ(xs[i] + ys[i], sum.get(i));
+      EXPECT_EQ((xs[i] + ys[i]) % mod, wrapped.get(i));
+      EXPECT_EQ(p, product.get(i));
+      EXPECT_EQ(p % p1, m1.get(i));
+      EXPECT_EQ(p % p2, m2.get(i));
+      EXPECT_EQ(p % p3, m3.get(i));
+    }
+  }
+  set_limb_tier(initial);
+
+  batch_mul(a, a, b);
+  EXPECT_EQ(xs[5] * ys[5] % mod, a.get(5));
+  EXPECT_THROW(big_batch(std::vector<big_integer>{-1}, 2), std::invalid_argument);
+  EXPECT_THROW(big_batch(std::vector<big_integer>{mod}, limbs), std::invalid_argument);
+  EXPECT_THROW(batch_mod(m2, product, p1), std::invalid_argument);
+}
+
+TEST(correctness, small_values) {
+  std::vector<std::string> values = {"0", "1", "-1", "2", "4294967295", "-4294967296", "4294967297",
+                                     "9223372036854775807", "-9223372036854775808", "18446744073709551615",
+                                     "-18446744073709551615", "12345678901234", "-98765432109"};
+  for (std::string const& x : values) {
+    for (std::string const& y : values) {
+      big_integer a(x), b(y);
+      big_integer_gmp ga(x), gb(y);
+      EXPECT_EQ(to_string(ga + gb), to_string(a + b)) << x << " " << y;
+      EXPECT_EQ(to_string(ga - gb), to_string(a - b)) << x << " " << y;
+      EXPECT_EQ(to_string(ga * gb), to_string(a * b)) << x << " " << y;
+      if (y != "0") {
+        EXPECT_EQ(to_string(ga / gb), to_string(a / b)) << x << " " << y;
+        EXPECT_EQ(to_string(ga % gb), to_string(a % b)) << x << " " << y;
+      }
+      EXPECT_EQ(ga < gb, a < b) << x << " " << y;
+      EXPECT_EQ(ga == gb, a == b) << x << " " << y;
+    }
+    for (int shift : {0, 1, 31, 32, 33, 63, 64, 65, 100}) {
+      big_integer a(x);
+      big_integer_gmp ga(x);
+      EXPECT_EQ(to_string(ga << shift), to_string(a << shift)) << x << " " << shift;
+      EXPECT_EQ(to_string(ga >> shift), to_string(a >> shift)) << x << " " << shift;
+    }
+  }
+}
+
+TEST(correctness, small_values_do_not_allocate) {
+  counting_resource counter;
+  {
+    limb_resource_scope scope(&counter);
+    std::vector<big_integer> values(1000);
+    for (size_t i = 0; i != values.size(); ++i) {
+      values[i] = big_integer(static_cast<int>(i)) * 1000003 - 77;
+      values[i] = values[i] * values[i] / 3 + (values[i] << 20) - (values[i] >> 2) % 1000;
+    }
+    EXPECT_EQ(big_integer("333716475208683323"), values[999]);
+    EXPECT_EQ(0u, counter.allocated);
+
+    big_integer big = values[999] * values[999];
+    EXPECT_LT(0u, counter.allocated);
+  }
+  EXPECT_EQ(0u, counter.live);
+}
+
+TEST(correctness, bits) {
+  std::vector<big_integer> values = {0, 1, -1, 2, -2, big_integer(1) << 64, -(big_integer(1) << 64),
+                                     (big_integer(1) << 64) - 1, -(big_integer(1) << 95) + 1};
+  for (size_t i = 0; i != 20; ++i) {
+    values.push_back((rand_big(i) << static_cast<int>(i * 13)) * (i % 2 ? -1 : 1));
+  }
+  limb_tier initial = active_limb_tier();
+  for (limb_tier tier : {limb_tier::generic, limb_tier::adx, limb_tier::avx2, limb_tier::avx512}) {
+    if (!set_limb_tier(tier)) {
+      continue;
+    }
+    for (big_integer const& a : values) {
+      size_t len = bit_length(a);
+      EXPECT_TRUE(a < 0 ? a >= -(big_integer(1) << static_cast<int>(len))
+                        : a < (big_integer(1) << static_cast<int>(len))) << a;
+      EXPECT_TRUE(len == 0 || (a < 0 ? a < -(big_integer(1) << static_cast<int>(len - 1))
+                                     : a >= (big_integer(1) << static_cast<int>(len - 1)))) << a;
+      size_t count = 0;
+      for (size_t k = 0; k != len + 70; ++k) {
+        big_integer bit = big_integer(1) << static_cast<int>(k);
+        bool set = ((a >> static_cast<int>(k)) & 1) == 1;
+        EXPECT_EQ(set, test_bit(a, k)) << a << " " << k;
+        count += (set != (a < 0));
+        big_integer b = a;
+        EXPECT_EQ(a | bit, set_bit(b, k)) << a << " " << k;
+        b = a;
+        EXPECT_EQ(a & ~bit, clear_bit(b, k)) << a << " " << k;
+        b = a;
+        EXPECT_EQ(a ^ bit, flip_bit(b, k)) << a << " " << k;
+      }
+      EXPECT_EQ(count, popcount(a)) << a << " " << limb_tier_name(tier);
+      EXPECT_EQ(a & -a, lowest_set_bit(a)) << a;
+      if (a != 0) {
+        EXPECT_EQ(big_integer(1) << static_cast<int>(count_trailing_zeros(a)), lowest_set_bit(a)) << a;
+      }
+    }
+  }
+  set_limb_tier(initial);
+  EXPECT_THROW(count_trailing_zeros(big_integer(0)), std::invalid_argument);
+}
+
+TEST(correctness, big_random) {
+  big_random rng(7);
+  for (size_t k : {0, 1, 31, 32, 33, 64, 1000}) {
+    big_integer x = rng.bits(k);
+    EXPECT_TRUE(x >= 0 && bit_length(x) <= k) << k << " " << x;
+  }
+  EXPECT_NE(rng.bits(1000), rng.bits(1000));
+
+  big_integer m = (big_integer(1) << 200) + 1;
+  for (size_t i = 0; i != 100; ++i) {
+    big_integer x = rng.below(m);
+    EXPECT_TRUE(x >= 0 && x < m) << x;
+  }
+  std::vector<size_t> seen(3);
+  for (size_t i = 0; i != 300; ++i) {
+    big_integer x = rng.below(big_integer(3));
+    ASSERT_TRUE(x >= 0 && x < 3) << x;
+    seen[std::stoi(to_string(x))]++;
+  }
+  for (size_t c : seen) {
+    EXPECT_LT(50u, c);
+  }
+  EXPECT_THROW(rng.below(big_integer(0)), std::invalid_argument);
+  EXPECT_THROW(rng.below(big_integer(-5)), std::invalid_argument);
+
+  big_random a(123), b(123);
+  EXPECT_EQ(a.bits(5000), b.bits(5000));
+}
+
+TEST(correctness, big_rational) {
+  EXPECT_EQ(big_integer(6), gcd(big_integer(-12), big_integer(18)));
+  EXPECT_EQ(big_integer(0), gcd(big_integer(0), big_integer(0)));
+  EXPECT_EQ(big_integer(7), gcd(big_integer(0), big_integer(-7)));
+
+  big_rational h;
+  for (int k = 1; k <= 20; ++k) {
+    h += big_rational(1, k);
+  }
+  EXPECT_EQ("55835135/15519504", to_string(h));
+
+  big_rational t;
+  for (int k = 1; k <= 200; ++k) {
+    t.add_mul(big_rational(1, k), big_rational(1, k + 1));
+  }
+  EXPECT_EQ(big_rational(200, 201), t);
+  EXPECT_EQ(big_integer(201), t.denominator());
+
+  EXPECT_TRUE(big_rational(1, 3) < big_rational(1, 2));
+  EXPECT_TRUE(big_rational(-1, 2) < big_rational(1, 3));
+  EXPECT_TRUE(big_rational(-1, 2) < big_rational(-1, 3));
+  EXPECT_EQ(big_rational(2, 4), big_rational(-1, -2));
+  EXPECT_EQ("-3/2", to_string(big_rational("6/-4")));
+  EXPECT_EQ("5", to_string(big_rational("10/2")));
+  big_rational const c(6, 4);
+  EXPECT_EQ("3/2", to_string(c));
+  EXPECT_EQ(big_rational(3, 2), c);
+  EXPECT_THROW(big_rational(1, 0), std::invalid_argument);
+  EXPECT_THROW(big_rational(1) / big_rational(0), std::invalid_argument);
+
+  for (size_t i = 0; i != 50; ++i) {
+    big_integer a = rand_big(i % 7) * (i % 2 ? -1 : 1), b = rand_big(i % 5) + 1;
+    big_integer c = rand_big(i % 3) * (i % 3 ? 1 : -1), d = rand_big(i % 4) + 1;
+    big_rational x(a, b), y(c, d);
+    EXPECT_EQ(big_rational(a * d + c * b), (x + y) * big_rational(b * d));
+    EXPECT_EQ(big_rational(a * d - c * b), (x - y) * big_rational(b * d));
+    EXPECT_EQ(big_rational(a * c, b * d), x * y);
+    EXPECT_EQ(x + x * y, big_rational(x).add_mul(x, y));
+    EXPECT_EQ(x - y * y, big_rational(x).sub_mul(y, y));
+    EXPECT_EQ(a * d < c * b, x < y);
+    if (c != 0) {
+      EXPECT_EQ(x, x / y * y);
+    }
+    EXPECT_EQ(big_integer(1), gcd(x.numerator(), x.denominator()));
+    EXPECT_TRUE(x.denominator() > 0);
+  }
+
+  // nothing from a scoped resource may outlive the scope
+  big_rational x(rand_big(20), rand_big(20) + 1), y(rand_big(20), rand_big(20) + 1);
+  big_rational z = x;
+  {
+    std::pmr::monotonic_buffer_resource pool;
+    limb_resource_scope scope(&pool);
+    big_rational t(rand_big(20), rand_big(20) + 1);
+    t += y;
+    t.add_mul(y, y);
+  }
+  z += y;
+  z.add_mul(y, y);
+  EXPECT_EQ(x + y + y * y, z);
+}
+
+TEST(correctness, big_float) {
+  size_t const p = 400;
+  EXPECT_EQ("3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117068",
+            to_string(pi_constant(p), 100));
+  EXPECT_EQ("2.718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427",
+            to_string(e_constant(p), 100));
+  EXPECT_EQ("6.931471805599453094172321214581765680755001343602552541206800094933936219696947156058633269964186875e-1",
+            to_string(log2_constant(p), 100));
+  EXPECT_EQ("1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573",
+            to_string(sqrt(big_float(big_integer(2), 0, p)), 100));
+
+  EXPECT_EQ("1.5e3", to_string(big_float("1.5e3"), 2));
+  EXPECT_EQ("-1.25e-1", to_string(big_float("-0.125"), 3));
+  EXPECT_EQ("1.2345", to_string(big_float("12345e-4"), 5));
+  EXPECT_EQ(big_integer(-3), trunc(big_float("-3.99")));
+  EXPECT_TRUE(big_float(1) / big_float(3) * big_float(3) < big_float(1));
+  EXPECT_TRUE(big_float("0.1") < big_float("0.10001"));
+  EXPECT_TRUE(big_float("-2") < big_float("-1.5"));
+  EXPECT_EQ(big_float(6), big_float("1.5") * big_float(4));
+  EXPECT_EQ(big_float(0), big_float("2.5") - big_float("2.5"));
+  EXPECT_THROW(big_float(1) / big_float(0), std::invalid_argument);
+  EXPECT_THROW(sqrt(big_float(-1)), std::invalid_argument);
+  EXPECT_THROW(big_float("1.2.3"), std::invalid_argument);
+
+  // the Newton paths agree with long division to all but the last few bits
+  size_t const q = 5000;
+  big_float a = pi_constant(q), b = e_constant(q) + big_float(big_integer(rand_big(200)), -6000, q);
+  big_float quotient = a / b;
+  big_float root = sqrt(a);
+  size_t threshold = newton_div_threshold();
+  set_newton_div_threshold(256);
+  big_float eps(big_integer(1), -static_cast<int64_t>(q) + 8, q);
+  big_float dq = a / b - quotient, dr = sqrt(a) - root;
+  EXPECT_TRUE(-eps < dq && dq < eps) << dq;
+  EXPECT_TRUE(-eps < dr && dr < eps) << dr;
+  EXPECT_EQ(to_string(pi_constant(p), 100), to_string(pi_constant(q), 100));
+  set_newton_div_threshold(threshold);
+
+  // and the same inside a scope over a short-lived resource
+  std::string digits = to_string(pi_constant(p), 100);
+  {
+    std::pmr::monotonic_buffer_resource pool;
+    limb_resource_scope scope(&pool);
+    EXPECT_EQ(digits, to_string(pi_constant(p), 100));
+  }
+  EXPECT_EQ(digits, to_string(pi_constant(p), 100));
+
+  // the halves of long ranges run as pool tasks and give the same sums
+  hypergeometric_series s;
+  s.a = [](size_t k) { return big_integer(static_cast<int>(k % 7)) - 3; };
+  s.p = [](size_t k) { return big_integer(static_cast<int>(2 * k + 1)); };
+  s.q = [](size_t k) { return big_integer(static_cast<int>(3 * k + 2)); };
+  split_product serial = binary_split(s, 0, 300);
+  size_t cutoff = parallel_split_cutoff(), threads = mul_threads();
+  set_mul_threads(4);
+  set_parallel_split_cutoff(4);
+  split_product parallel = binary_split(s, 0, 300);
+  EXPECT_EQ(serial.P, parallel.P);
+  EXPECT_EQ(serial.Q, parallel.Q);
+  EXPECT_EQ(serial.T, parallel.T);
+  EXPECT_EQ(digits, to_string(pi_constant(p), 100));
+  set_parallel_split_cutoff(cutoff);
+  set_mul_threads(threads);
+}
+
+TEST(correctness, big_decimal) {
+  for (std::string s : {"0", "1.50", "-0.001", "123456789012345678901234567890.000000000123", "0.000000000",
+                        "-1000000000", "999999999.999999999"}) {
+    EXPECT_EQ(s, to_string(big_decimal(s)));
+  }
+  EXPECT_EQ("0.5", to_string(big_decimal("+.5")));
+  EXPECT_EQ("0.000", to_string(big_decimal("-0.000")));
+  EXPECT_THROW(big_decimal("1.2.3"), std::invalid_argument);
+  EXPECT_THROW(big_decimal("-"), std::invalid_argument);
+
+  EXPECT_EQ("3.75", to_string(big_decimal("1.5") + big_decimal("2.25")));
+  EXPECT_EQ("-0.75", to_string(big_decimal("1.5") - big_decimal("2.25")));
+  EXPECT_EQ("3.375", to_string(big_decimal("1.5") * big_decimal("2.25")));
+  EXPECT_EQ("-999999999.999999999", to_string(big_decimal("0.000000001") - big_decimal("1000000000")));
+  EXPECT_EQ(big_decimal("1.50"), big_decimal("1.5"));
+  EXPECT_TRUE(big_decimal("-1.51") < big_decimal("-1.5"));
+  EXPECT_TRUE(big_decimal("0.999999999999") < big_decimal(1));
+
+  big_decimal r("2.345");
+  r.rescale(2);
+  EXPECT_EQ("2.35", to_string(r));
+  r = big_decimal("-2.3449999999999");
+  r.rescale(2);
+  EXPECT_EQ("-2.34", to_string(r));
+  r.rescale(12);
+  EXPECT_EQ("-2.340000000000", to_string(r));
+  r.rescale(0);
+  EXPECT_EQ("-2", to_string(r));
+  r = big_decimal("0.4");
+  r.rescale(0);
+  EXPECT_EQ("0", to_string(r));
+
+  EXPECT_EQ("0.3333", to_string(divide(big_decimal(1), big_decimal(3), 4)));
+  EXPECT_EQ("-0.6667", to_string(divide(big_decimal(-2), big_decimal(3), 4)));
+  EXPECT_EQ("0.13", to_string(divide(big_decimal(1), big_decimal(8), 2)));
+  EXPECT_EQ("40", to_string(divide(big_decimal("10.00"), big_decimal("0.25"), 0)));
+  EXPECT_THROW(divide(big_decimal(1), big_decimal("0.00"), 2), std::invalid_argument);
+
+  for (size_t i = 0; i != 30; ++i) {
+    big_integer a = rand_big(i) * (i % 2 ? -1 : 1), b = rand_big(i / 2 + 1) * (i % 3 ? 1 : -1);
+    size_t sa = i % 7, sb = i % 11;
+    big_decimal x(a, sa), y(b, sb);
+    EXPECT_EQ(a, x.unscaled());
+    EXPECT_EQ(x, big_decimal(to_string(x)));
+    size_t s = std::max(sa, sb);
+    EXPECT_EQ(a * pow(big_integer(10), s - sa) + b * pow(big_integer(10), s - sb), (x + y).unscaled());
+    EXPECT_EQ(a * pow(big_integer(10), s - sa) - b * pow(big_integer(10), s - sb), (x - y).unscaled());
+    EXPECT_EQ(a * b, (x * y).unscaled());
+    EXPECT_EQ(sa + sb, (x * y).scale());
+  }
+}
+
+TEST(correctness, mod_int) {
+  EXPECT_THROW(mod_context(big_integer(10)), std::invalid_argument);
+  EXPECT_THROW(mod_context(big_integer(1)), std::invalid_argument);
+  EXPECT_THROW(mod_context(big_integer(-7)), std::invalid_argument);
+
+  for (size_t i = 0; i != 24; ++i) {
+    big_integer m = rand_big(i % 12);
+    if (!test_bit(m, 0)) {
+      m += 1;
+    }
+    if (m <= 1) {
+      m = 3;
+    }
+    mod_context ctx(m);
+    big_integer a = rand_big(i % 12 + 1) * (i % 2 ? -1 : 1), b = rand_big(i % 5);
+    mod_int x(ctx, a), y(ctx, b);
+    big_integer ra = (a % m + m) % m, rb = b % m;
+    EXPECT_EQ(ra, x.value());
+    EXPECT_EQ(ra * rb % m, (x * y).value());
+    EXPECT_EQ((ra + rb) % m, (x + y).value());
+    EXPECT_EQ((ra - rb + m) % m, (x - y).value());
+    EXPECT_EQ((m - ra) % m, (-x).value());
+    big_integer e = rand_big(i % 3), re = 1;
+    for (size_t k = bit_length(e); k-- > 0;) {
+      re = re * re % m;
+      if (test_bit(e, k)) {
+        re = re * ra % m;
+      }
+    }
+    EXPECT_EQ(re, x.pow(e).value());
+    EXPECT_EQ(mod_int(ctx, 1), x.pow(0));
+  }
+
+  // 2^256 - 2^32 - 977, prime
+  big_integer p = (big_integer(1) << 256) - (big_integer(1) << 32) - 977;
+  mod_context field(p);
+  mod_int generic(field, 5);
+  fixed_mod_int<8> x(field, rand_big(10)), y(field, -rand_big(7));
+  big_integer rx = x.value(), ry = y.value();
+  for (size_t i = 0; i != 100; ++i) {
+    x = x * y + x;
+    y -= x;
+    rx = (rx * ry + rx) % p;
+    ry = ((ry - rx) % p + p) % p;
+  }
+  EXPECT_EQ(rx, x.value());
+  EXPECT_EQ(ry, y.value());
+  EXPECT_EQ(fixed_mod_int<8>(field, 1), x.pow(p - 1));
+  EXPECT_EQ(x.pow(p - 2) * x, fixed_mod_int<8>(field, 1));
+  EXPECT_THROW(fixed_mod_int<4>(field, 1), std::invalid_argument);
+  mod_context other(p - 2);
+  EXPECT_THROW(mod_int(other, 1) + generic, std::invalid_argument);
+}
+
+TEST(correctness, invmod) {
+  EXPECT_EQ(big_integer(4), invmod(big_integer(3), big_integer(11)));
+  EXPECT_EQ(big_integer(7), invmod(big_integer(-3), big_integer(11)));
+  EXPECT_EQ(big_integer(3), invmod(big_integer(5), big_integer(14)));
+  EXPECT_THROW(invmod(big_integer(6), big_integer(9)), std::invalid_argument);
+  EXPECT_THROW(invmod(big_integer(1), big_integer(1)), std::invalid_argument);
+
+  big_integer p = (big_integer(1) << 521) - 1;
+  std::vector<big_integer> values;
+  for (size_t i = 0; i != 200; ++i) {
+    values.push_back(rand_big(i % 25) * (i % 3 ? 1 : -1) + 1);
+  }
+  std::vector<big_integer> inv = values;
+  batch_invmod(inv, p);
+  for (size_t i = 0; i != values.size(); ++i) {
+    EXPECT_EQ(invmod(values[i], p), inv[i]);
+    EXPECT_EQ(big_integer(1), (values[i] * inv[i] % p + p) % p);
+  }
+  EXPECT_EQ("3", to_string(mod_int(mod_context(p), 3).value()));
+
+  std::vector<big_integer> even = {3, 5, 7, 9};
+  batch_invmod(even, big_integer(16));
+  EXPECT_EQ((std::vector<big_integer>{11, 13, 7, 9}), even);
+
+  std::vector<big_integer> singular = {3, 5, 6, 7}, copy = singular;
+  EXPECT_THROW(batch_invmod(singular, big_integer(9)), std::invalid_argument);
+  EXPECT_EQ(copy, singular);
+  EXPECT_THROW(batch_invmod(singular, big_integer(1)), std::invalid_argument);
+}
+
+TEST(correctness, rns) {
+  rns_basis small(0);
+  EXPECT_EQ(1u, small.size());
+  EXPECT_EQ(2147483647u, small.prime(0));
+  EXPECT_EQ(big_integer(-1), rns_int(small, -1).value());
+
+  rns_basis basis(3000);
+  EXPECT_LT(big_integer(1) << 3001, basis.product());
+  for (size_t i = 0; i != 20; ++i) {
+    big_integer a = rand_big(i % 16) * (i % 2 ? -1 : 1), b = rand_big(i % 7) * (i % 3 ? 1 : -1), c = rand_big(i % 4);
+    rns_int x(basis, a), y(basis, b), z(basis, c);
+    EXPECT_EQ(a, x.value());
+    EXPECT_EQ(a * b + c, (x * y + z).value());
+    EXPECT_EQ(a - b * c * c, (x - y * z * z).value());
+    EXPECT_EQ(-a, (-x).value());
+    big_integer p(basis.prime(i));
+    EXPECT_EQ((b % p + p) % p, big_integer(y.residue(i)));
+  }
+  rns_basis other(3000);
+  EXPECT_THROW(rns_int(basis, 1) + rns_int(other, 1), std::invalid_argument);
+
+  size_t cutoff = parallel_rns_cutoff(), threads = mul_threads();
+  set_mul_threads(4);
+  set_parallel_rns_cutoff(8);
+  big_integer a = rand_big(40), b = -rand_big(40);
+  {
+    // the tree conversions hand the resource on to their tasks
+    std::pmr::monotonic_buffer_resource pool;
+    limb_resource_scope scope(&pool);
+    rns_int x(basis, a), y(basis, b);
+    EXPECT_EQ(a * b - a, (x * y - x).value());
+  }
+  rns_int x(basis, a), y(basis, b);
+  EXPECT_EQ(a * b - a, (x * y - x).value());
+  set_parallel_rns_cutoff(cutoff);
+  set_mul_threads(threads);
+}
+
+TEST(correctness, divexact) {
+  EXPECT_EQ(big_integer(0), divexact(big_integer(0), big_integer(7)));
+  EXPECT_EQ(big_integer(-6), divexact(big_integer(42), big_integer(-7)));
+  EXPECT_EQ(big_integer(1) << 90, divexact(big_integer(1) << 100, big_integer(1024)));
+  EXPECT_THROW(divexact(big_integer(5), big_integer(0)), std::invalid_argument);
+
+  for (size_t i = 0; i != 60; ++i) {
+    big_integer a = rand_big(i % 20) * (i % 2 ? -1 : 1);
+    big_integer b = (rand_big(i % 6) + 1) << static_cast<int>(i * 7 % 70);
+    if (i % 3 == 0) {
+      b = -b;
+    }
+    EXPECT_EQ(a, divexact(a * b, b));
+    if (a != 0) {
+      EXPECT_EQ(b, divexact(a * b, a));
+    }
+  }
+
+  big_integer accumulator = 1;
+  std::vector<int> multipliers;
+  for (size_t i = 0; i != 100; ++i) {
+    multipliers.push_back(myrand());
+    accumulator *= multipliers.back();
+  }
+  for (size_t i = 1; i != multipliers.size(); ++i) {
+    accumulator = divexact(accumulator, big_integer(multipliers[i]));
+  }
+  EXPECT_EQ(big_integer(multipliers[0]), accumulator);
+}
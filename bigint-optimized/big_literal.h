@@ -0,0 +1,130 @@
+#ifndef BIG_LITERAL_H
+#define BIG_LITERAL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "big_integer.h"
+#include "big_uint.h"
+
+// Result of the _bi literal: the limbs are parsed by the compiler, so
+// materialising a big_integer is a single copy and converting to a
+// fixed-width type is a constant.
+template<size_t N>
+struct big_literal
+{
+    std::array<uint32_t, N> num;
+    bool sign;
+
+    constexpr big_literal operator+() const {
+        return *this;
+    }
+
+    constexpr big_literal operator-() const {
+        big_literal res = *this;
+        res.sign = !res.sign;
+        return res;
+    }
+
+    operator big_integer() const {
+        big_integer res;
+        res.num.resize(N);
+        for (size_t i = 0; i < N; i++) {
+            res.num[i] = num[i];
+        }
+        res.sign = sign;
+        res.remFrontZero();
+        return res;
+    }
+
+    template<size_t Bits, bool Signed>
+    constexpr operator big_fixed<Bits, Signed>() const {
+        static_assert(N <= big_fixed<Bits, Signed>::LIMBS, "literal does not fit into the fixed-width type");
+        big_fixed<Bits, Signed> res;
+        for (size_t i = 0; i < N; i++) {
+            res.num[i] = num[i];
+        }
+        return sign ? -res : res;
+    }
+};
+
+constexpr uint32_t big_literal_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+        return (c | 0x20) - 'a' + 10;
+    }
+    return UINT32_MAX;
+}
+
+constexpr bool big_literal_valid(char const* s, size_t first, size_t count, uint32_t base) {
+    for (size_t i = first; i < count; i++) {
+        if (s[i] != '\'' && big_literal_digit(s[i]) >= base) {
+            return false;
+        }
+    }
+    return first < count;
+}
+
+template<size_t Bound>
+constexpr std::array<uint32_t, Bound> big_literal_parse(char const* s, size_t first, size_t count, uint32_t base) {
+    std::array<uint32_t, Bound> res = {};
+    for (size_t i = first; i < count; i++) {
+        if (s[i] == '\'') {
+            continue;
+        }
+        uint64_t carry = big_literal_digit(s[i]);
+        for (size_t k = 0; k < Bound; k++) {
+            carry += static_cast<uint64_t>(res[k]) * base;
+            res[k] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+    return res;
+}
+
+template<size_t Bound>
+constexpr size_t big_literal_used(std::array<uint32_t, Bound> const& a) {
+    size_t n = Bound;
+    while (n > 1 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// Decimal, 0x hexadecimal and 0b binary digits with optional ' separators.
+// A leading zero does not switch to octal, as in big_integer(std::string).
+template<char... Cs>
+struct big_literal_parser
+{
+    static constexpr char DIGITS[] = {Cs...};
+    static constexpr size_t COUNT = sizeof...(Cs);
+    static constexpr uint32_t BASE =
+        (COUNT > 2 && DIGITS[0] == '0' && (DIGITS[1] | 0x20) == 'x') ? 16 :
+        (COUNT > 2 && DIGITS[0] == '0' && (DIGITS[1] | 0x20) == 'b') ? 2 : 10;
+    static constexpr size_t FIRST = (BASE == 10 ? 0 : 2);
+    static_assert(big_literal_valid(DIGITS, FIRST, COUNT, BASE), "invalid digit in big integer literal");
+
+    // log2(10) < 10 / 3, so this never underestimates
+    static constexpr size_t BOUND = (BASE == 16 ? 4 * COUNT : BASE == 2 ? COUNT : 10 * COUNT / 3 + 1) / 32 + 1;
+    static constexpr std::array<uint32_t, BOUND> WIDE = big_literal_parse<BOUND>(DIGITS, FIRST, COUNT, BASE);
+    static constexpr size_t LIMBS = big_literal_used(WIDE);
+
+    static constexpr big_literal<LIMBS> value() {
+        big_literal<LIMBS> res = {};
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.num[i] = WIDE[i];
+        }
+        res.sign = false;
+        return res;
+    }
+};
+
+template<char... Cs>
+constexpr big_literal<big_literal_parser<Cs...>::LIMBS> operator"" _bi() {
+    return big_literal_parser<Cs...>::value();
+}
+
+#endif // BIG_LITERAL_H
@@ -0,0 +1,32 @@
+#ifndef BIG_RANDOM_H
+#define BIG_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "big_integer.h"
+
+// Random big integers written straight into the limbs from a 64-bit
+// Mersenne Twister, so an n-limb value costs n / 2 engine steps.
+class big_random
+{
+public:
+    // per-thread generator with a fixed seed, so runs are reproducible
+    static big_random& local();
+
+    explicit big_random(uint64_t seed = std::mt19937_64::default_seed);
+    void seed(uint64_t seed);
+
+    // uniform in [0, 2^k)
+    big_integer bits(size_t k);
+    // uniform in [0, m) by rejection; throws std::invalid_argument unless m > 0
+    big_integer below(big_integer_view m);
+    // r[0..n) = random limbs
+    void fill(uint32_t* r, size_t n);
+
+private:
+    std::mt19937_64 engine;
+};
+
+#endif // BIG_RANDOM_H
@@ -0,0 +1,85 @@
+#ifndef BIG_RATIONAL_H
+#define BIG_RATIONAL_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "big_integer.h"
+
+// Exact fraction num / den with den > 0. Common factors are cancelled
+// lazily: only once the fraction has doubled in limbs since the last
+// reduction, or when the numerator or denominator is asked for. Comparisons
+// cross-multiply and to_string reduces a copy, so neither writes to a const
+// fraction.
+class big_rational
+{
+public:
+    big_rational();
+    big_rational(int a);
+    big_rational(big_integer const& n);
+    // n / d; throws std::invalid_argument if d is 0
+    big_rational(big_integer const& n, big_integer const& d);
+    // "p" or "p/q"; throws std::invalid_argument on a zero denominator
+    explicit big_rational(std::string const& str);
+
+    // in lowest terms; these reduce in place, so they need a non-const
+    // fraction
+    big_integer const& numerator();
+    big_integer const& denominator();
+
+    big_rational& operator+=(big_rational const& rhs);
+    big_rational& operator-=(big_rational const& rhs);
+    big_rational& operator*=(big_rational const& rhs);
+    // throws std::invalid_argument when dividing by zero
+    big_rational& operator/=(big_rational const& rhs);
+
+    // *this += a * b and *this -= a * b without a big_rational temporary
+    big_rational& add_mul(big_rational const& a, big_rational const& b);
+    big_rational& sub_mul(big_rational const& a, big_rational const& b);
+
+    big_rational operator+() const;
+    big_rational operator-() const;
+
+    int sign() const;
+    // a no-op if nothing has changed since the last reduction
+    void normalize();
+
+    friend int compare(big_rational const& a, big_rational const& b);
+
+private:
+    void add(big_integer const& n, big_integer const& d, bool negate);
+    void maybe_normalize();
+
+    big_integer num;
+    big_integer den;
+    // limbs of num and den right after the last reduction
+    size_t reduced_limbs;
+    // in lowest terms, so normalize() has nothing to do
+    bool reduced;
+};
+
+// Limbs of numerator plus denominator below which a fraction is never
+// reduced automatically.
+void set_rational_reduce_threshold(size_t limbs);
+size_t rational_reduce_threshold();
+
+big_rational operator+(big_rational a, big_rational const& b);
+big_rational operator-(big_rational a, big_rational const& b);
+big_rational operator*(big_rational a, big_rational const& b);
+big_rational operator/(big_rational a, big_rational const& b);
+
+// -1, 0 or 1
+int compare(big_rational const& a, big_rational const& b);
+
+bool operator==(big_rational const& a, big_rational const& b);
+bool operator!=(big_rational const& a, big_rational const& b);
+bool operator<(big_rational const& a, big_rational const& b);
+bool operator>(big_rational const& a, big_rational const& b);
+bool operator<=(big_rational const& a, big_rational const& b);
+bool operator>=(big_rational const& a, big_rational const& b);
+
+std::string to_string(big_rational const& a);
+std::ostream& operator<<(std::ostream& s, big_rational const& a);
+
+#endif // BIG_RATIONAL_H
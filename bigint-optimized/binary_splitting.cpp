@@ -0,0 +1,137 @@
+#include "binary_splitting.h"
+#include "limb_resource.h"
+#include "big_literal.h"
+#include "task_pool.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+// extra bits the constants are computed with before the final rounding
+static const size_t GUARD = 32;
+
+static std::atomic<size_t> split_cutoff(256);
+
+void set_parallel_split_cutoff(size_t terms) {
+    split_cutoff = terms;
+}
+
+size_t parallel_split_cutoff() {
+    return split_cutoff;
+}
+
+split_product binary_split(hypergeometric_series const& s, size_t lo, size_t hi) {
+    if (lo >= hi) {
+        throw std::invalid_argument("empty range of terms");
+    }
+    if (hi - lo == 1) {
+        big_integer p = s.p(lo);
+        big_integer t = s.a(lo) * p;
+        return split_product{p, s.q(lo), t};
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    split_product l, r;
+    if (hi - lo >= parallel_split_cutoff()) {
+        std::pmr::memory_resource* resource = limb_resource();
+        task_pool::global().run(2, [&](size_t k) {
+            limb_resource_scope scope(resource);
+            if (k == 0) {
+                l = binary_split(s, lo, mid);
+            } else {
+                r = binary_split(s, mid, hi);
+            }
+        });
+    } else {
+        l = binary_split(s, lo, mid);
+        r = binary_split(s, mid, hi);
+    }
+    l.T *= r.Q;
+    r.T *= l.P;
+    l.T += r.T;
+    l.P *= r.P;
+    l.Q *= r.Q;
+    return l;
+}
+
+big_float sum_series(hypergeometric_series const& s, size_t terms, size_t precision) {
+    size_t p = (precision != 0 ? precision : float_precision());
+    split_product r = binary_split(s, 0, terms);
+    big_float res = big_float(r.T, 0, p + GUARD) / big_float(r.Q, 0, p + GUARD);
+    res.set_precision(p);
+    return res;
+}
+
+// 640320^3 / 24; every term adds log2(640320^3 / 1728) > 47 bits. A literal,
+// not a static big_integer, whose limbs could come from the limb_resource
+// of whichever thread first got here.
+static constexpr auto C3_24 = 10939058860032000_bi;
+
+static big_integer term_index(size_t k) {
+    return big_integer(static_cast<unsigned int>(k));
+}
+
+big_float pi_constant(size_t precision) {
+    size_t p = (precision != 0 ? precision : float_precision());
+    hypergeometric_series s;
+    s.a = [](size_t k) {
+        return big_integer(13591409) + big_integer(545140134) * term_index(k);
+    };
+    s.p = [](size_t k) {
+        if (k == 0) {
+            return big_integer(1);
+        }
+        big_integer K = term_index(k);
+        return -(K * 6 - 5) * (K * 2 - 1) * (K * 6 - 1);
+    };
+    s.q = [](size_t k) {
+        if (k == 0) {
+            return big_integer(1);
+        }
+        big_integer K = term_index(k);
+        return K * K * K * C3_24;
+    };
+    size_t q = p + GUARD;
+    split_product r = binary_split(s, 0, q / 47 + 2);
+    // pi = 426880 * sqrt(10005) / sum = 426880 * sqrt(10005) * Q / T
+    big_float res = big_float(r.Q * 426880, 0, q) * sqrt(big_float(big_integer(10005), 0, q)) / big_float(r.T, 0, q);
+    res.set_precision(p);
+    return res;
+}
+
+big_float e_constant(size_t precision) {
+    size_t p = (precision != 0 ? precision : float_precision());
+    hypergeometric_series s;
+    s.a = [](size_t) {
+        return big_integer(1);
+    };
+    s.p = [](size_t) {
+        return big_integer(1);
+    };
+    s.q = [](size_t k) {
+        return k == 0 ? big_integer(1) : term_index(k);
+    };
+    // enough terms that the first one left out, 1 / n!, is below 2^-(p + GUARD)
+    size_t n = 1;
+    for (double bits = 0; bits < p + GUARD; n++) {
+        bits += std::log2(static_cast<double>(n));
+    }
+    return sum_series(s, n, p);
+}
+
+big_float log2_constant(size_t precision) {
+    size_t p = (precision != 0 ? precision : float_precision());
+    hypergeometric_series s;
+    s.a = [](size_t) {
+        return big_integer(1);
+    };
+    s.p = [](size_t k) {
+        return k == 0 ? big_integer(1) : -term_index(k);
+    };
+    s.q = [](size_t k) {
+        return k == 0 ? big_integer(1) : term_index(2 * k + 1) * 4;
+    };
+    // every term is under an eighth of the previous one
+    big_float res = sum_series(s, (p + GUARD) / 3 + 2, p + GUARD) * big_float(big_integer(3), -2, p + GUARD);
+    res.set_precision(p);
+    return res;
+}
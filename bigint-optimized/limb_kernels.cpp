@@ -0,0 +1,515 @@
+#include "limb_kernels.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define LIMB_KERNELS_X86 1
+#endif
+
+static uint32_t add_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) + b[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+static uint32_t sub_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(cur);
+        borrow = static_cast<uint32_t>(cur >> 63);
+    }
+    return borrow;
+}
+
+static uint32_t mul_1_generic(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) * m;
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+static uint32_t addmul_1_generic(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) * m + r[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+static void and_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] & b[i];
+    }
+}
+
+static void ior_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] | b[i];
+    }
+}
+
+static void xor_n_generic(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = a[i] ^ b[i];
+    }
+}
+
+static void com_n_generic(uint32_t* r, uint32_t const* a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = ~a[i];
+    }
+}
+
+static int cmp_n_generic(uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t popcount_n_generic(uint32_t const* a, size_t n) {
+    uint64_t res = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = a[i];
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+        res += (x * 0x01010101u) >> 24;
+    }
+    return res;
+}
+
+#ifdef LIMB_KERNELS_X86
+// The x86-64 kernels work on pairs of limbs as one 64-bit word and finish an
+// odd tail limb by hand. addmul_1 keeps two independent carry chains: adcx
+// adds the low product halves, adox the high half of the previous word.
+
+static inline unsigned long long load64(uint32_t const* p) {
+    unsigned long long x;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline void store64(uint32_t* p, unsigned long long x) {
+    std::memcpy(p, &x, sizeof(x));
+}
+
+__attribute__((target("adx")))
+static uint32_t add_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        unsigned long long s;
+        c = _addcarryx_u64(c, load64(a + i), load64(b + i), &s);
+        store64(r + i, s);
+    }
+    uint64_t carry = c;
+    if (i < n) {
+        carry += static_cast<uint64_t>(a[i]) + b[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+__attribute__((target("adx")))
+static uint32_t sub_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        unsigned long long s;
+        c = _subborrow_u64(c, load64(a + i), load64(b + i), &s);
+        store64(r + i, s);
+    }
+    uint32_t borrow = c;
+    if (i < n) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(cur);
+        borrow = static_cast<uint32_t>(cur >> 63);
+    }
+    return borrow;
+}
+
+__attribute__((target("bmi2,adx")))
+static uint32_t mul_1_adx(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    unsigned char c = 0;
+    unsigned long long hi_prev = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        unsigned long long hi;
+        unsigned long long lo = _mulx_u64(load64(a + i), m, &hi);
+        unsigned long long s;
+        c = _addcarryx_u64(c, lo, hi_prev, &s);
+        store64(r + i, s);
+        hi_prev = hi;
+    }
+    uint64_t carry = hi_prev + c;
+    if (i < n) {
+        carry += static_cast<uint64_t>(a[i]) * m;
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+static uint32_t addmul_1_adx(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    uint64_t carry = 0;
+    size_t words = n / 2;
+    if (words > 0) {
+        uint32_t* rp = r;
+        uint32_t const* ap = a;
+        unsigned long long hi = 0;
+        // lea, mov, mulx and jrcxz leave the flags alone, so CF and OF
+        // carry the two chains across iterations
+        __asm__(
+            "xor %%r10d, %%r10d\n\t"
+            "xor %%r8d, %%r8d\n"
+            "1:\n\t"
+            "mulx (%[a]), %%rax, %%r9\n\t"
+            "adcx (%[r]), %%rax\n\t"
+            "adox %%r8, %%rax\n\t"
+            "mov %%rax, (%[r])\n\t"
+            "mov %%r9, %%r8\n\t"
+            "lea 8(%[a]), %[a]\n\t"
+            "lea 8(%[r]), %[r]\n\t"
+            "lea -1(%%rcx), %%rcx\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n"
+            "2:\n\t"
+            "adcx %%r10, %%r8\n\t"
+            "adox %%r10, %%r8\n\t"
+            "mov %%r8, %[hi]"
+            : [a] "+r"(ap), [r] "+r"(rp), "+c"(words), [hi] "=&r"(hi)
+            : "d"(static_cast<unsigned long long>(m))
+            : "rax", "r8", "r9", "r10", "cc", "memory");
+        carry = hi;
+    }
+    if (n % 2 != 0) {
+        carry += static_cast<uint64_t>(a[n - 1]) * m + r[n - 1];
+        r[n - 1] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+__attribute__((target("popcnt")))
+static uint64_t popcount_n_popcnt(uint32_t const* a, size_t n) {
+    uint64_t res = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        res += __builtin_popcountll(load64(a + i));
+    }
+    if (i < n) {
+        res += __builtin_popcount(a[i]);
+    }
+    return res;
+}
+
+// AVX2 and AVX-512 versions of the bitwise kernels handle 8 or 16 limbs per
+// instruction and leave the remainder to the scalar loops above.
+
+__attribute__((target("avx2")))
+static void and_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_and_si256(x, y));
+    }
+    and_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void ior_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(x, y));
+    }
+    ior_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void xor_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, y));
+    }
+    xor_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void com_n_avx2(uint32_t* r, uint32_t const* a, size_t n) {
+    __m256i ones = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_xor_si256(x, ones));
+    }
+    com_n_generic(r + i, a + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int cmp_n_avx2(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = n;
+    while (i >= 8) {
+        i -= 8;
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+        unsigned int eq = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+        if (eq != 0xFF) {
+            size_t k = i + 31 - __builtin_clz(~eq & 0xFF);
+            return a[k] < b[k] ? -1 : 1;
+        }
+    }
+    return cmp_n_generic(a, b, i);
+}
+
+__attribute__((target("avx512f")))
+static void and_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(r + i, _mm512_and_si512(x, y));
+    }
+    and_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void ior_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(r + i, _mm512_or_si512(x, y));
+    }
+    ior_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void xor_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(r + i, _mm512_xor_si512(x, y));
+    }
+    xor_n_generic(r + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void com_n_avx512(uint32_t* r, uint32_t const* a, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        _mm512_storeu_si512(r + i, _mm512_ternarylogic_epi32(x, x, x, 0x55));
+    }
+    com_n_generic(r + i, a + i, n - i);
+}
+
+__attribute__((target("avx512f")))
+static int cmp_n_avx512(uint32_t const* a, uint32_t const* b, size_t n) {
+    size_t i = n;
+    while (i >= 16) {
+        i -= 16;
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __mmask16 ne = _mm512_cmpneq_epu32_mask(x, y);
+        if (ne != 0) {
+            size_t k = i + 31 - __builtin_clz(ne);
+            return a[k] < b[k] ? -1 : 1;
+        }
+    }
+    return cmp_n_generic(a, b, i);
+}
+#endif
+
+static inline uint64_t hash_round(uint64_t h, uint64_t w) {
+    static const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    h += w * P2;
+    h = (h << 31) | (h >> 33);
+    return h * P1;
+}
+
+uint64_t hash_n(uint32_t const* a, size_t n) {
+    // four independent lanes over 64-bit words, so the multiplies pipeline
+    uint64_t h[4] = {0x60EA27EEADC0B5D6ULL, 0xC2B2AE3D27D4EB4FULL, 0, 0x61C8864E7A143579ULL};
+    size_t words = n / 2;
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        for (size_t l = 0; l < 4; l++) {
+            uint64_t w;
+            std::memcpy(&w, a + 2 * (i + l), sizeof(w));
+            h[l] = hash_round(h[l], w);
+        }
+    }
+    uint64_t res = ((h[0] << 1) | (h[0] >> 63)) + ((h[1] << 7) | (h[1] >> 57))
+                 + ((h[2] << 12) | (h[2] >> 52)) + ((h[3] << 18) | (h[3] >> 46));
+    for (; i < words; i++) {
+        uint64_t w;
+        std::memcpy(&w, a + 2 * i, sizeof(w));
+        res = hash_round(res, w);
+    }
+    if (n % 2 != 0) {
+        res = hash_round(res, a[n - 1]);
+    }
+    res ^= n;
+    res ^= res >> 33;
+    res *= 0xFF51AFD7ED558CCDULL;
+    res ^= res >> 33;
+    res *= 0xC4CEB9FE1A85EC53ULL;
+    res ^= res >> 33;
+    return res;
+}
+
+namespace {
+struct limb_kernel_table {
+    uint32_t (*add_n)(uint32_t*, uint32_t const*, uint32_t const*, size_t);
+    uint32_t (*sub_n)(uint32_t*, uint32_t const*, uint32_t const*, size_t);
+    uint32_t (*mul_1)(uint32_t*, uint32_t const*, size_t, uint32_t);
+    uint32_t (*addmul_1)(uint32_t*, uint32_t const*, size_t, uint32_t);
+    void (*and_n)(uint32_t*, uint32_t const*, uint32_t const*, size_t);
+    void (*ior_n)(uint32_t*, uint32_t const*, uint32_t const*, size_t);
+    void (*xor_n)(uint32_t*, uint32_t const*, uint32_t const*, size_t);
+    void (*com_n)(uint32_t*, uint32_t const*, size_t);
+    int (*cmp_n)(uint32_t const*, uint32_t const*, size_t);
+    uint64_t (*popcount_n)(uint32_t const*, size_t);
+};
+}
+
+static limb_kernel_table const TABLES[] = {
+    {add_n_generic, sub_n_generic, mul_1_generic, addmul_1_generic,
+     and_n_generic, ior_n_generic, xor_n_generic, com_n_generic, cmp_n_generic, popcount_n_generic},
+#ifdef LIMB_KERNELS_X86
+    {add_n_adx, sub_n_adx, mul_1_adx, addmul_1_adx,
+     and_n_generic, ior_n_generic, xor_n_generic, com_n_generic, cmp_n_generic, popcount_n_popcnt},
+    {add_n_adx, sub_n_adx, mul_1_adx, addmul_1_adx,
+     and_n_avx2, ior_n_avx2, xor_n_avx2, com_n_avx2, cmp_n_avx2, popcount_n_popcnt},
+    {add_n_adx, sub_n_adx, mul_1_adx, addmul_1_adx,
+     and_n_avx512, ior_n_avx512, xor_n_avx512, com_n_avx512, cmp_n_avx512, popcount_n_popcnt},
+#endif
+};
+
+static char const* const TIER_NAMES[] = {"generic", "adx", "avx2", "avx512"};
+
+static limb_tier best_supported_tier() {
+#ifdef LIMB_KERNELS_X86
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        bool bmi2 = (ebx >> 8) & 1;
+        bool adx = (ebx >> 19) & 1;
+        __builtin_cpu_init();
+        if (bmi2 && adx && __builtin_cpu_supports("popcnt")) {
+            if (__builtin_cpu_supports("avx512f")) {
+                return limb_tier::avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return limb_tier::avx2;
+            }
+            return limb_tier::adx;
+        }
+    }
+#endif
+    return limb_tier::generic;
+}
+
+static limb_tier initial_tier() {
+    limb_tier best = best_supported_tier();
+    char const* forced = std::getenv("BIGINT_LIMB_TIER");
+    if (forced != nullptr) {
+        for (size_t i = 0; i <= static_cast<size_t>(best); i++) {
+            if (std::strcmp(forced, TIER_NAMES[i]) == 0) {
+                return static_cast<limb_tier>(i);
+            }
+        }
+    }
+    return best;
+}
+
+// atomic, as task_pool workers dispatch through it while a caller may switch
+// tiers; relaxed, as the tables it picks between never change
+static std::atomic<limb_tier>& current_tier() {
+    static std::atomic<limb_tier> tier(initial_tier());
+    return tier;
+}
+
+static limb_kernel_table const& kernels() {
+    return TABLES[static_cast<size_t>(current_tier().load(std::memory_order_relaxed))];
+}
+
+limb_tier active_limb_tier() {
+    return current_tier().load(std::memory_order_relaxed);
+}
+
+bool set_limb_tier(limb_tier tier) {
+    if (tier > best_supported_tier()) {
+        return false;
+    }
+    current_tier().store(tier, std::memory_order_relaxed);
+    return true;
+}
+
+char const* limb_tier_name(limb_tier tier) {
+    return TIER_NAMES[static_cast<size_t>(tier)];
+}
+
+uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    return kernels().add_n(r, a, b, n);
+}
+
+uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    return kernels().sub_n(r, a, b, n);
+}
+
+uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    return kernels().mul_1(r, a, n, m);
+}
+
+uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t m) {
+    return kernels().addmul_1(r, a, n, m);
+}
+
+void and_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    kernels().and_n(r, a, b, n);
+}
+
+void ior_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    kernels().ior_n(r, a, b, n);
+}
+
+void xor_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    kernels().xor_n(r, a, b, n);
+}
+
+void com_n(uint32_t* r, uint32_t const* a, size_t n) {
+    kernels().com_n(r, a, n);
+}
+
+int cmp_n(uint32_t const* a, uint32_t const* b, size_t n) {
+    return kernels().cmp_n(a, b, n);
+}
+
+uint64_t popcount_n(uint32_t const* a, size_t n) {
+    return kernels().popcount_n(a, n);
+}
@@ -0,0 +1,55 @@
+#ifndef LIMB_KERNELS_H
+#define LIMB_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Loops over little-endian limb arrays shared by the big_integer operators.
+// r may coincide with a (and b), but must not partially overlap them.
+
+// r[0..n) = a[0..n) + b[0..n), returns the carry
+uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+// r[0..n) = a[0..n) - b[0..n), returns the borrow
+uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+// r[0..n) = a[0..n) * m, returns the high limb
+uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t m);
+
+// r[0..n) += a[0..n) * m, returns the high limb
+uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t m);
+
+// r[0..n) = a[0..n) &, |, ^ b[0..n)
+void and_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+void ior_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+void xor_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+// r[0..n) = ~a[0..n)
+void com_n(uint32_t* r, uint32_t const* a, size_t n);
+
+// compares a[0..n) and b[0..n) from the most significant limb, returns -1, 0 or 1
+int cmp_n(uint32_t const* a, uint32_t const* b, size_t n);
+
+// number of set bits in a[0..n)
+uint64_t popcount_n(uint32_t const* a, size_t n);
+
+// 64-bit hash of a[0..n); equal limb arrays give equal hashes on every tier
+uint64_t hash_n(uint32_t const* a, size_t n);
+
+// Kernel implementations, from the most portable one up; each tier needs the
+// CPU features of the previous ones, and every x86 tier needs popcnt. The
+// best tier the CPU supports is picked on first use; the BIGINT_LIMB_TIER
+// environment variable (set to a tier name) can force a lower one.
+enum class limb_tier {
+    generic,
+    adx,
+    avx2,
+    avx512,
+};
+
+limb_tier active_limb_tier();
+// returns false and keeps the current tier if the CPU lacks the features
+bool set_limb_tier(limb_tier tier);
+char const* limb_tier_name(limb_tier tier);
+
+#endif // LIMB_KERNELS_H
@@ -0,0 +1,72 @@
+#ifndef LIMB_RESOURCE_H
+#define LIMB_RESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+
+// Memory resource that new limb storage is taken from on the calling thread,
+// std::pmr::new_delete_resource() unless set. Storage goes back to the
+// resource it came from, so values may outlive the setting, but not the
+// resource itself: with a monotonic or pooled resource every big_integer
+// allocated from it must be gone before the resource is released. Note that
+// a value assigned inside the scope may end up holding storage from it.
+std::pmr::memory_resource* limb_resource();
+// returns the previous resource; nullptr restores the default
+std::pmr::memory_resource* set_limb_resource(std::pmr::memory_resource* r);
+
+// Routes the calling thread's limb allocations to r while in scope.
+class limb_resource_scope
+{
+public:
+    explicit limb_resource_scope(std::pmr::memory_resource* r);
+    limb_resource_scope(limb_resource_scope const&) = delete;
+    limb_resource_scope& operator=(limb_resource_scope const&) = delete;
+    ~limb_resource_scope();
+
+private:
+    std::pmr::memory_resource* saved;
+};
+
+// Allocator for limb containers. A default-constructed or copy-constructed
+// container picks up the thread's current resource; assignment keeps the
+// target's own.
+template<typename T>
+struct limb_allocator
+{
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    std::pmr::memory_resource* resource;
+
+    limb_allocator() : resource(limb_resource()) {}
+
+    template<typename U>
+    limb_allocator(limb_allocator<U> const& other) : resource(other.resource) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    limb_allocator select_on_container_copy_construction() const {
+        return limb_allocator();
+    }
+};
+
+template<typename T, typename U>
+bool operator==(limb_allocator<T> const& a, limb_allocator<U> const& b) {
+    return a.resource == b.resource || a.resource->is_equal(*b.resource);
+}
+
+template<typename T, typename U>
+bool operator!=(limb_allocator<T> const& a, limb_allocator<U> const& b) {
+    return !(a == b);
+}
+
+#endif // LIMB_RESOURCE_H
@@ -0,0 +1,334 @@
+#ifndef MOD_INT_H
+#define MOD_INT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "big_integer.h"
+#include "limb_resource.h"
+
+// An odd modulus m > 1 of n limbs with what Montgomery multiplication
+// needs: R = 2^(32 * n), -m^-1 mod 2^64 and R^2 mod m. The values bound to
+// it keep a pointer, so it must outlive them.
+class mod_context
+{
+public:
+    // throws std::invalid_argument unless m is odd and greater than 1
+    explicit mod_context(big_integer const& m);
+    mod_context(mod_context const&) = delete;
+    mod_context& operator=(mod_context const&) = delete;
+
+    // inline, as the fixed-size kernels read them in their inner loops
+    big_integer const& modulus() const {
+        return m;
+    }
+
+    size_t limbs() const {
+        return m_limbs.size();
+    }
+
+    uint32_t const* mod() const {
+        return m_limbs.data();
+    }
+
+    // -m^-1 mod 2^32 and mod 2^64
+    uint32_t inv() const {
+        return static_cast<uint32_t>(m_inv);
+    }
+
+    uint64_t inv64() const {
+        return m_inv;
+    }
+
+    // R^2 mod m, which maps a value into Montgomery form
+    uint32_t const* r2() const {
+        return r2_limbs.data();
+    }
+
+private:
+    big_integer m;
+    std::vector<uint32_t> m_limbs;
+    std::vector<uint32_t> r2_limbs;
+    uint64_t m_inv;
+};
+
+// r = a * b / R mod m, for a, b < m; r may be a or b
+void mont_mul(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c);
+// r = a + b mod m and r = a - b mod m, for a, b < m
+void mod_add(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c);
+void mod_sub(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c);
+
+__extension__ typedef unsigned __int128 mont_uint128_t;
+
+// CIOS Montgomery multiplication over K words of type W, with DW twice as
+// wide: add a * b[i], then cancel the low word with a multiple of m.
+template<typename W, typename DW, size_t K>
+inline void mont_mul_words(W* r, W const* a, W const* b, W const* m, W inv) {
+    constexpr int BITS = 8 * sizeof(W);
+    W t[K + 2] = {};
+    for (size_t i = 0; i < K; i++) {
+        DW carry = 0;
+        for (size_t j = 0; j < K; j++) {
+            carry += static_cast<DW>(a[j]) * b[i] + t[j];
+            t[j] = static_cast<W>(carry);
+            carry >>= BITS;
+        }
+        carry += t[K];
+        t[K] = static_cast<W>(carry);
+        t[K + 1] = static_cast<W>(carry >> BITS);
+        W u = t[0] * inv;
+        carry = (static_cast<DW>(u) * m[0] + t[0]) >> BITS;
+        for (size_t j = 1; j < K; j++) {
+            carry += static_cast<DW>(u) * m[j] + t[j];
+            t[j - 1] = static_cast<W>(carry);
+            carry >>= BITS;
+        }
+        carry += t[K];
+        t[K - 1] = static_cast<W>(carry);
+        t[K] = t[K + 1] + static_cast<W>(carry >> BITS);
+    }
+    // t < 2m
+    bool ge = (t[K] != 0);
+    if (!ge) {
+        ge = true;
+        for (size_t i = K; i-- > 0;) {
+            if (t[i] != m[i]) {
+                ge = (t[i] > m[i]);
+                break;
+            }
+        }
+    }
+    W borrow = 0;
+    for (size_t i = 0; i < K; i++) {
+        W x = t[i], y = (ge ? m[i] : 0);
+        r[i] = x - y - borrow;
+        borrow = (x < y || x - y < borrow);
+    }
+}
+
+// The same for a modulus of exactly N limbs, inline over fixed-size arrays;
+// an even N runs as N / 2 64-bit words, a quarter of the multiplications.
+template<size_t N>
+inline void mont_mul_n(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    if constexpr (N % 2 == 0) {
+        uint64_t x[N / 2], y[N / 2], m[N / 2], z[N / 2];
+        std::memcpy(x, a, sizeof(x));
+        std::memcpy(y, b, sizeof(y));
+        std::memcpy(m, c.mod(), sizeof(m));
+        mont_mul_words<uint64_t, mont_uint128_t, N / 2>(z, x, y, m, c.inv64());
+        std::memcpy(r, z, sizeof(z));
+    } else {
+        mont_mul_words<uint32_t, uint64_t, N>(r, a, b, c.mod(), c.inv());
+    }
+}
+
+template<size_t N>
+inline void mod_add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    uint32_t const* m = c.mod();
+    uint32_t s[N];
+    uint64_t carry = 0;
+    for (size_t i = 0; i < N; i++) {
+        carry += static_cast<uint64_t>(a[i]) + b[i];
+        s[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    uint32_t d[N];
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < N; i++) {
+        uint64_t cur = static_cast<uint64_t>(s[i]) - m[i] - borrow;
+        d[i] = static_cast<uint32_t>(cur);
+        borrow = cur >> 63;
+    }
+    // s - m is the sum unless it went below zero without a carry out of s
+    bool keep = (borrow != 0 && carry == 0);
+    for (size_t i = 0; i < N; i++) {
+        r[i] = (keep ? s[i] : d[i]);
+    }
+}
+
+template<size_t N>
+inline void mod_sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    uint32_t const* m = c.mod();
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < N; i++) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(cur);
+        borrow = cur >> 63;
+    }
+    uint64_t carry = 0;
+    uint32_t mask = (borrow != 0 ? UINT32_MAX : 0);
+    for (size_t i = 0; i < N; i++) {
+        carry += static_cast<uint64_t>(r[i]) + (m[i] & mask);
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+}
+
+// A residue modulo the modulus of a mod_context, kept in Montgomery form
+// x * R mod m so that a chain of operations converts only at its ends.
+// Limbs = 0 takes any modulus and keeps its limbs in a vector; Limbs > 0
+// needs a modulus of exactly that many limbs and keeps them inline, so
+// nothing allocates.
+template<size_t Limbs>
+class basic_mod_int
+{
+public:
+    // 0
+    explicit basic_mod_int(mod_context const& c) : ctx(&c) {
+        init();
+    }
+
+    // x mod m, for any x; throws std::invalid_argument if Limbs does not
+    // match the modulus
+    basic_mod_int(mod_context const& c, big_integer const& x) : ctx(&c) {
+        init();
+        big_integer r = x % c.modulus();
+        if (r.sign) {
+            r += c.modulus();
+        }
+        storage_t plain = v;
+        big_integer_view rv(r);
+        std::copy(rv.num, rv.num + rv.len, plain.data());
+        multiply(v.data(), plain.data(), c.r2());
+    }
+
+    mod_context const& context() const {
+        return *ctx;
+    }
+
+    // the residue in [0, m)
+    big_integer value() const {
+        storage_t one = v;
+        std::fill(one.begin(), one.end(), 0);
+        one[0] = 1;
+        storage_t res = v;
+        multiply(res.data(), v.data(), one.data());
+        big_integer r(big_integer_view(res.data(), res.size()));
+        r.remFrontZero();
+        return r;
+    }
+
+    basic_mod_int& operator+=(basic_mod_int const& rhs) {
+        check(rhs);
+        if constexpr (Limbs == 0) {
+            mod_add(v.data(), v.data(), rhs.v.data(), *ctx);
+        } else {
+            mod_add_n<Limbs>(v.data(), v.data(), rhs.v.data(), *ctx);
+        }
+        return *this;
+    }
+
+    basic_mod_int& operator-=(basic_mod_int const& rhs) {
+        check(rhs);
+        if constexpr (Limbs == 0) {
+            mod_sub(v.data(), v.data(), rhs.v.data(), *ctx);
+        } else {
+            mod_sub_n<Limbs>(v.data(), v.data(), rhs.v.data(), *ctx);
+        }
+        return *this;
+    }
+
+    basic_mod_int& operator*=(basic_mod_int const& rhs) {
+        check(rhs);
+        multiply(v.data(), v.data(), rhs.v.data());
+        return *this;
+    }
+
+    basic_mod_int operator-() const {
+        basic_mod_int res(*ctx);
+        return res -= *this;
+    }
+
+    // *this^e by left-to-right square and multiply; throws
+    // std::invalid_argument for a negative e
+    basic_mod_int pow(big_integer const& e) const {
+        if (e < 0) {
+            throw std::invalid_argument("negative exponent");
+        }
+        basic_mod_int res(*ctx, 1);
+        for (size_t i = bit_length(e); i-- > 0;) {
+            res *= res;
+            if (test_bit(e, i)) {
+                res *= *this;
+            }
+        }
+        return res;
+    }
+
+    friend basic_mod_int operator+(basic_mod_int a, basic_mod_int const& b) {
+        return a += b;
+    }
+
+    friend basic_mod_int operator-(basic_mod_int a, basic_mod_int const& b) {
+        return a -= b;
+    }
+
+    friend basic_mod_int operator*(basic_mod_int a, basic_mod_int const& b) {
+        return a *= b;
+    }
+
+    // Montgomery form is one-to-one, so the limbs compare directly
+    friend bool operator==(basic_mod_int const& a, basic_mod_int const& b) {
+        return a.ctx == b.ctx && std::equal(a.v.begin(), a.v.end(), b.v.begin());
+    }
+
+    friend bool operator!=(basic_mod_int const& a, basic_mod_int const& b) {
+        return !(a == b);
+    }
+
+private:
+    typedef typename std::conditional<Limbs == 0, std::vector<uint32_t, limb_allocator<uint32_t>>,
+                                      std::array<uint32_t, Limbs>>::type storage_t;
+
+    void init() {
+        if constexpr (Limbs == 0) {
+            v.resize(ctx->limbs());
+        } else if (ctx->limbs() != Limbs) {
+            throw std::invalid_argument("modulus does not have the fixed number of limbs");
+        }
+        std::fill(v.begin(), v.end(), 0);
+    }
+
+    void multiply(uint32_t* r, uint32_t const* a, uint32_t const* b) const {
+        if constexpr (Limbs == 0) {
+            mont_mul(r, a, b, *ctx);
+        } else {
+            mont_mul_n<Limbs>(r, a, b, *ctx);
+        }
+    }
+
+    void check(basic_mod_int const& rhs) const {
+        if (ctx != rhs.ctx) {
+            throw std::invalid_argument("residues of different moduli");
+        }
+    }
+
+    storage_t v;
+    mod_context const* ctx;
+};
+
+// any odd modulus
+typedef basic_mod_int<0> mod_int;
+
+// a modulus of exactly Limbs limbs, e.g. fixed_mod_int<8> for 256 bits
+template<size_t Limbs>
+using fixed_mod_int = basic_mod_int<Limbs>;
+
+// Replaces each of values[0..count) by its inverse modulo m with
+// Montgomery's trick: prefix products, one invmod of the last, and a
+// backward pass that peels the inverses off it. An odd m runs them in
+// Montgomery form, three multiplications per value plus the conversions in
+// and out of it; an even m inverts each value on its own. Throws
+// std::invalid_argument, leaving the values as they were, if m <= 1 or a
+// value is not invertible. The pointer and count, and the vector overload,
+// stand in for a span, which C++17 does not have.
+void batch_invmod(big_integer* values, size_t count, big_integer const& m);
+void batch_invmod(std::vector<big_integer>& values, big_integer const& m);
+
+#endif // MOD_INT_H
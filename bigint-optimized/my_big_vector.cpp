@@ -1,4 +1,5 @@
 #include "my_big_vector.h"
+#include "limb_resource.h"
 
 #include <algorithm>
 
@@ -6,13 +7,14 @@ my_big_vector::my_big_vector() {
     my_big_vector* an = my_big_vector::alloc(0);
     cap = an->cap;
     cnt = an->cnt;
+    resource = an->resource;
     std::copy_n(an->data, cap, data);
 }
 
 void my_big_vector::try_del() {
 	--cnt;
 	if (!cnt) {
-		operator delete(this);
+		resource->deallocate(this, sizeof(my_big_vector) + cap * sizeof(uint32_t), alignof(my_big_vector));
 	}
 }
 
@@ -26,7 +28,9 @@ bool my_big_vector::is_alone() {
 }
 
 my_big_vector* my_big_vector::alloc(size_t capacity) {
-	auto res = static_cast<my_big_vector*>(operator new(sizeof(my_big_vector) + capacity * sizeof(uint32_t)));
+	std::pmr::memory_resource* resource = limb_resource();
+	auto res = static_cast<my_big_vector*>(resource->allocate(sizeof(my_big_vector) + capacity * sizeof(uint32_t), alignof(my_big_vector)));
+	res->resource = resource;
 	res->cnt = 1;
 	res->cap = capacity;
 	return res;
@@ -3,10 +3,13 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <memory_resource>
 
 struct my_big_vector {
 	size_t cnt;
 	size_t cap;
+	// where the block came from and goes back to
+	std::pmr::memory_resource* resource;
 	uint32_t data[];
 
 	my_big_vector();
@@ -1,4 +1,5 @@
 #include "my_vector.h"
+#include "limb_resource.h"
 
 #include <algorithm>
 
@@ -7,6 +8,17 @@ size_t get_new_cap(size_t cap) {
 	return cap == 0 ? 1 : (cap * 2);
 }
 
+// shares the block unless it came from another memory resource than the
+// current one, so copies never tie their owner to a foreign pool
+my_big_vector* share(my_big_vector* big, size_t size) {
+	if (big->resource == limb_resource()) {
+		return big->make_copy();
+	}
+	my_big_vector* res = my_big_vector::alloc(big->cap);
+	std::copy_n(big->data, size, res->data);
+	return res;
+}
+
 my_vector::my_vector() : my_size(0) {}
 
 my_vector::my_vector(std::vector<uint32_t> vec) : my_size(vec.size()){
@@ -23,7 +35,7 @@ my_vector::my_vector(my_vector const& other) : my_size(other.my_size) {
 	if (is_small()) {
 		std::copy_n(other.small, my_size, small);
 	} else {
-		big = other.big->make_copy();
+		big = share(other.big, size());
 	}
 }
 
@@ -36,7 +48,7 @@ my_vector& my_vector::operator=(my_vector const& other) {
 		if (other.is_small()) {
 			std::copy_n(other.small, my_size, small);
 		} else {
-			big = other.big->make_copy();
+			big = share(other.big, size());
 		}
 	}
 	return *this;
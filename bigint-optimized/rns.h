@@ -0,0 +1,90 @@
+#ifndef RNS_H
+#define RNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "big_integer.h"
+#include "limb_resource.h"
+
+// The primes below 2^31 that an rns_int keeps its residues modulo, with
+// their product M held as a product tree for the conversions. A basis must
+// outlive the values bound to it.
+class rns_basis
+{
+public:
+    // the fewest primes, largest first, for every |x| < 2^bits to come back
+    // exactly
+    explicit rns_basis(size_t bits);
+    rns_basis(rns_basis const&) = delete;
+    rns_basis& operator=(rns_basis const&) = delete;
+
+    size_t size() const;
+    uint32_t prime(size_t i) const;
+    big_integer const& product() const;
+
+private:
+    friend class rns_int;
+
+    void build(size_t v, size_t lo, size_t hi);
+    void cofactors(size_t v, size_t lo, size_t hi, big_integer const& c);
+    void reduce(size_t v, size_t lo, size_t hi, big_integer const& x, uint32_t* out) const;
+    big_integer combine(size_t v, size_t lo, size_t hi, uint32_t const* c) const;
+
+    std::vector<uint32_t> primes;
+    // -p^-1 mod 2^32, 2^64 mod p, and (M / p)^-1 mod p
+    std::vector<uint32_t> inv;
+    std::vector<uint32_t> r2;
+    std::vector<uint32_t> weights;
+    // node 1 is M, nodes 2v and 2v + 1 the products of the halves of node v
+    std::vector<big_integer> tree;
+};
+
+// An integer as its residues modulo the primes of a basis, each kept in
+// 32-bit Montgomery form. +, - and * work lane by lane with no carries
+// between them: the lane loops are vectorised per instruction set like the
+// big_batch kernels, and long ones split over task_pool. Results are
+// correct modulo M, so they come back exactly while |x| < M / 2; there is
+// no division or comparison. Going in reduces down the product tree and
+// coming out recombines up it by the Chinese remainder theorem.
+class rns_int
+{
+public:
+    // 0
+    explicit rns_int(rns_basis const& b);
+    rns_int(rns_basis const& b, big_integer const& x);
+
+    rns_basis const& basis() const;
+    // the value in (-M / 2, M / 2] congruent to this one
+    big_integer value() const;
+    // x mod prime(i)
+    uint32_t residue(size_t i) const;
+
+    // throw std::invalid_argument for values of different bases
+    rns_int& operator+=(rns_int const& rhs);
+    rns_int& operator-=(rns_int const& rhs);
+    rns_int& operator*=(rns_int const& rhs);
+
+    rns_int operator-() const;
+
+private:
+    typedef std::vector<uint32_t, limb_allocator<uint32_t>> lanes_t;
+
+    void check(rns_int const& rhs) const;
+
+    lanes_t res;
+    rns_basis const* base;
+};
+
+rns_int operator+(rns_int a, rns_int const& b);
+rns_int operator-(rns_int a, rns_int const& b);
+rns_int operator*(rns_int a, rns_int const& b);
+
+// Lane loops of at least twice this many residues are split into tasks of
+// at least this many on task_pool::global(), as are the tree conversions
+// of bases that large.
+void set_parallel_rns_cutoff(size_t lanes);
+size_t parallel_rns_cutoff();
+
+#endif // RNS_H
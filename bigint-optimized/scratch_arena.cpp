@@ -0,0 +1,107 @@
+#include "scratch_arena.h"
+
+#include <algorithm>
+
+static const size_t MIN_CHUNK = 1024;
+
+scratch_arena& scratch_arena::local() {
+    static thread_local scratch_arena arena;
+    return arena;
+}
+
+void scratch_arena::add_chunk(size_t size) {
+    chunks.push_back(chunk{std::unique_ptr<uint32_t[]>(new uint32_t[size]), size, 0});
+}
+
+uint32_t* scratch_arena::push(size_t n) {
+    if (chunks.empty() || chunks[top].size - chunks[top].used < n) {
+        if (!chunks.empty() && chunks[top].used != 0) {
+            top++;
+        }
+        // every chunk from top on is empty here
+        if (top == chunks.size() || chunks[top].size < n) {
+            chunks.resize(top);
+            add_chunk(std::max(n, std::max(MIN_CHUNK, capacity())));
+        }
+    }
+    chunk& c = chunks[top];
+    uint32_t* res = c.limbs.get() + c.used;
+    c.used += n;
+    return res;
+}
+
+void scratch_arena::pop(size_t n) {
+    chunks[top].used -= n;
+    if (chunks[top].used == 0 && top > 0) {
+        top--;
+    }
+}
+
+void scratch_arena::reserve(size_t limbs) {
+    size_t cap = capacity();
+    if (cap >= limbs) {
+        return;
+    }
+    if (used() == 0) {
+        chunks.clear();
+        top = 0;
+        add_chunk(limbs);
+    } else {
+        add_chunk(limbs - cap);
+    }
+}
+
+void scratch_arena::trim() {
+    if (used() == 0) {
+        chunks.clear();
+        top = 0;
+    } else {
+        chunks.resize(top + 1);
+    }
+}
+
+size_t scratch_arena::capacity() const {
+    size_t res = 0;
+    for (chunk const& c : chunks) {
+        res += c.size;
+    }
+    return res;
+}
+
+size_t scratch_arena::used() const {
+    size_t res = 0;
+    for (chunk const& c : chunks) {
+        res += c.used;
+    }
+    return res;
+}
+
+scratch_limbs::scratch_limbs(size_t n) : limbs(scratch_arena::local().push(n)), n(n) {}
+
+scratch_limbs::~scratch_limbs() {
+    scratch_arena::local().pop(n);
+}
+
+uint32_t* scratch_limbs::data() {
+    return limbs;
+}
+
+size_t scratch_limbs::size() const {
+    return n;
+}
+
+uint32_t& scratch_limbs::operator[](size_t i) {
+    return limbs[i];
+}
+
+void scratch_reserve(size_t limbs) {
+    scratch_arena::local().reserve(limbs);
+}
+
+size_t scratch_capacity() {
+    return scratch_arena::local().capacity();
+}
+
+void scratch_trim() {
+    scratch_arena::local().trim();
+}
@@ -0,0 +1,419 @@
+#include "big_batch.h"
+#include "limb_kernels.h"
+#include "scratch_arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIG_BATCH_X86 1
+#endif
+
+// lanes per tile, so that the temporaries of batch_mod stay in cache
+static const size_t TILE = 256;
+
+big_batch::big_batch(size_t count, size_t limbs) : count(count), width(limbs) {
+    data.resize(count * limbs);
+}
+
+big_batch::big_batch(std::vector<big_integer> const& values, size_t limbs) : big_batch(values.size(), limbs) {
+    for (size_t i = 0; i < values.size(); i++) {
+        set(i, values[i]);
+    }
+}
+
+size_t big_batch::size() const {
+    return count;
+}
+
+size_t big_batch::limbs() const {
+    return width;
+}
+
+uint32_t* big_batch::row(size_t l) {
+    return data.data() + l * count;
+}
+
+uint32_t const* big_batch::row(size_t l) const {
+    return data.data() + l * count;
+}
+
+big_integer big_batch::get(size_t i) const {
+    scratch_limbs column(width);
+    for (size_t l = 0; l < width; l++) {
+        column[l] = row(l)[i];
+    }
+    return big_integer(big_integer_view(column.data(), width));
+}
+
+void big_batch::set(size_t i, big_integer const& value) {
+    big_integer_view v(value);
+    if (v.sign || (v.len > width && !(width == 0 && v.num[0] == 0))) {
+        throw std::invalid_argument("value does not fit into the batch");
+    }
+    for (size_t l = 0; l < width; l++) {
+        row(l)[i] = (l < v.len ? v.num[l] : 0);
+    }
+}
+
+std::vector<big_integer> big_batch::to_vector() const {
+    std::vector<big_integer> res;
+    res.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        res.push_back(get(i));
+    }
+    return res;
+}
+
+namespace {
+// limb l of lane i is at p[l * stride + i]
+struct in_rows {
+    uint32_t const* p;
+    size_t stride;
+    size_t limbs;
+
+    uint32_t const* row(size_t l) const {
+        return p + l * stride;
+    }
+};
+
+struct out_rows {
+    uint32_t* p;
+    size_t stride;
+    size_t limbs;
+
+    uint32_t* row(size_t l) const {
+        return p + l * stride;
+    }
+
+    operator in_rows() const {
+        return in_rows{p, stride, limbs};
+    }
+};
+}
+
+// The lane loops below are written once and inlined into one copy per
+// instruction set, where the compiler vectorises the inner loop over lanes.
+
+__attribute__((always_inline))
+static inline void add_lanes(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    std::fill(c, c + t, 0);
+    for (size_t l = 0; l < r.limbs; l++) {
+        uint32_t* z = r.row(l);
+        if (l < a.limbs && l < b.limbs) {
+            uint32_t const* x = a.row(l);
+            uint32_t const* y = b.row(l);
+            for (size_t i = 0; i < t; i++) {
+                uint64_t s = static_cast<uint64_t>(x[i]) + y[i] + c[i];
+                z[i] = static_cast<uint32_t>(s);
+                c[i] = static_cast<uint32_t>(s >> 32);
+            }
+        } else if (l < a.limbs || l < b.limbs) {
+            uint32_t const* x = (l < a.limbs ? a.row(l) : b.row(l));
+            for (size_t i = 0; i < t; i++) {
+                uint64_t s = static_cast<uint64_t>(x[i]) + c[i];
+                z[i] = static_cast<uint32_t>(s);
+                c[i] = static_cast<uint32_t>(s >> 32);
+            }
+        } else {
+            for (size_t i = 0; i < t; i++) {
+                z[i] = c[i];
+                c[i] = 0;
+            }
+        }
+    }
+}
+
+// r = a * b; r must not overlap a or b
+__attribute__((always_inline))
+static inline void mul_lanes(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    for (size_t l = 0; l < r.limbs; l++) {
+        std::fill(r.row(l), r.row(l) + t, 0);
+    }
+    for (size_t la = 0; la < a.limbs && la < r.limbs; la++) {
+        uint32_t const* x = a.row(la);
+        std::fill(c, c + t, 0);
+        size_t lb = 0;
+        for (; lb < b.limbs && la + lb < r.limbs; lb++) {
+            uint32_t const* y = b.row(lb);
+            uint32_t* z = r.row(la + lb);
+            for (size_t i = 0; i < t; i++) {
+                uint64_t s = static_cast<uint64_t>(x[i]) * y[i] + z[i] + c[i];
+                z[i] = static_cast<uint32_t>(s);
+                c[i] = static_cast<uint32_t>(s >> 32);
+            }
+        }
+        if (la + lb < r.limbs) {
+            std::copy(c, c + t, r.row(la + lb));
+        }
+    }
+}
+
+// r = a * m for the same m[0..ml) in every lane; r must not overlap a
+__attribute__((always_inline))
+static inline void mul_const_lanes(out_rows r, in_rows a, uint32_t const* m, size_t ml, size_t t, uint32_t* c) {
+    for (size_t l = 0; l < r.limbs; l++) {
+        std::fill(r.row(l), r.row(l) + t, 0);
+    }
+    for (size_t la = 0; la < a.limbs && la < r.limbs; la++) {
+        uint32_t const* x = a.row(la);
+        std::fill(c, c + t, 0);
+        size_t lb = 0;
+        for (; lb < ml && la + lb < r.limbs; lb++) {
+            uint64_t y = m[lb];
+            uint32_t* z = r.row(la + lb);
+            for (size_t i = 0; i < t; i++) {
+                uint64_t s = x[i] * y + z[i] + c[i];
+                z[i] = static_cast<uint32_t>(s);
+                c[i] = static_cast<uint32_t>(s >> 32);
+            }
+        }
+        if (la + lb < r.limbs) {
+            std::copy(c, c + t, r.row(la + lb));
+        }
+    }
+}
+
+// r = a - b over r.limbs limbs; a and b have at least as many
+__attribute__((always_inline))
+static inline void sub_lanes(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    std::fill(c, c + t, 0);
+    for (size_t l = 0; l < r.limbs; l++) {
+        uint32_t const* x = a.row(l);
+        uint32_t const* y = b.row(l);
+        uint32_t* z = r.row(l);
+        for (size_t i = 0; i < t; i++) {
+            uint64_t d = static_cast<uint64_t>(x[i]) - y[i] - c[i];
+            z[i] = static_cast<uint32_t>(d);
+            c[i] = static_cast<uint32_t>(d >> 63);
+        }
+    }
+}
+
+// r -= m[0..r.limbs) in the lanes where r >= m, without branching on lanes
+__attribute__((always_inline))
+static inline void cond_sub_lanes(out_rows r, uint32_t const* m, size_t t, uint32_t* c) {
+    uint32_t* mask = c + t;
+    std::fill(c, c + t, 0);
+    for (size_t l = 0; l < r.limbs; l++) {
+        uint32_t const* z = r.row(l);
+        uint32_t y = m[l];
+        for (size_t i = 0; i < t; i++) {
+            uint64_t d = static_cast<uint64_t>(z[i]) - y - c[i];
+            c[i] = static_cast<uint32_t>(d >> 63);
+        }
+    }
+    for (size_t i = 0; i < t; i++) {
+        mask[i] = c[i] - 1;
+        c[i] = 0;
+    }
+    for (size_t l = 0; l < r.limbs; l++) {
+        uint32_t* z = r.row(l);
+        uint32_t y = m[l];
+        for (size_t i = 0; i < t; i++) {
+            uint64_t d = static_cast<uint64_t>(z[i]) - (y & mask[i]) - c[i];
+            z[i] = static_cast<uint32_t>(d);
+            c[i] = static_cast<uint32_t>(d >> 63);
+        }
+    }
+}
+
+static void add_lanes_generic(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    add_lanes(r, a, b, t, c);
+}
+
+static void mul_lanes_generic(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    mul_lanes(r, a, b, t, c);
+}
+
+static void mul_const_lanes_generic(out_rows r, in_rows a, uint32_t const* m, size_t ml, size_t t, uint32_t* c) {
+    mul_const_lanes(r, a, m, ml, t, c);
+}
+
+static void sub_lanes_generic(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    sub_lanes(r, a, b, t, c);
+}
+
+static void cond_sub_lanes_generic(out_rows r, uint32_t const* m, size_t t, uint32_t* c) {
+    cond_sub_lanes(r, m, t, c);
+}
+
+#ifdef BIG_BATCH_X86
+__attribute__((target("avx2")))
+static void add_lanes_avx2(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    add_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx2")))
+static void mul_lanes_avx2(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    mul_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx2")))
+static void mul_const_lanes_avx2(out_rows r, in_rows a, uint32_t const* m, size_t ml, size_t t, uint32_t* c) {
+    mul_const_lanes(r, a, m, ml, t, c);
+}
+
+__attribute__((target("avx2")))
+static void sub_lanes_avx2(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    sub_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx2")))
+static void cond_sub_lanes_avx2(out_rows r, uint32_t const* m, size_t t, uint32_t* c) {
+    cond_sub_lanes(r, m, t, c);
+}
+
+__attribute__((target("avx512f")))
+static void add_lanes_avx512(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    add_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx512f")))
+static void mul_lanes_avx512(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    mul_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx512f")))
+static void mul_const_lanes_avx512(out_rows r, in_rows a, uint32_t const* m, size_t ml, size_t t, uint32_t* c) {
+    mul_const_lanes(r, a, m, ml, t, c);
+}
+
+__attribute__((target("avx512f")))
+static void sub_lanes_avx512(out_rows r, in_rows a, in_rows b, size_t t, uint32_t* c) {
+    sub_lanes(r, a, b, t, c);
+}
+
+__attribute__((target("avx512f")))
+static void cond_sub_lanes_avx512(out_rows r, uint32_t const* m, size_t t, uint32_t* c) {
+    cond_sub_lanes(r, m, t, c);
+}
+#endif
+
+namespace {
+struct lane_kernel_table {
+    void (*add)(out_rows, in_rows, in_rows, size_t, uint32_t*);
+    void (*mul)(out_rows, in_rows, in_rows, size_t, uint32_t*);
+    void (*mul_const)(out_rows, in_rows, uint32_t const*, size_t, size_t, uint32_t*);
+    void (*sub)(out_rows, in_rows, in_rows, size_t, uint32_t*);
+    void (*cond_sub)(out_rows, uint32_t const*, size_t, uint32_t*);
+};
+}
+
+// indexed by limb_tier; the adx tier has nothing to add here
+static lane_kernel_table const TABLES[] = {
+    {add_lanes_generic, mul_lanes_generic, mul_const_lanes_generic, sub_lanes_generic, cond_sub_lanes_generic},
+#ifdef BIG_BATCH_X86
+    {add_lanes_generic, mul_lanes_generic, mul_const_lanes_generic, sub_lanes_generic, cond_sub_lanes_generic},
+    {add_lanes_avx2, mul_lanes_avx2, mul_const_lanes_avx2, sub_lanes_avx2, cond_sub_lanes_avx2},
+    {add_lanes_avx512, mul_lanes_avx512, mul_const_lanes_avx512, sub_lanes_avx512, cond_sub_lanes_avx512},
+#endif
+};
+
+static lane_kernel_table const& kernels() {
+    return TABLES[static_cast<size_t>(active_limb_tier())];
+}
+
+static in_rows tile(big_batch const& a, size_t i) {
+    return in_rows{a.row(0) + i, a.size(), a.limbs()};
+}
+
+static out_rows tile(big_batch& a, size_t i) {
+    return out_rows{a.row(0) + i, a.size(), a.limbs()};
+}
+
+static void check_sizes(big_batch const& r, big_batch const& a, big_batch const& b) {
+    if (r.size() != a.size() || r.size() != b.size()) {
+        throw std::invalid_argument("batches of different sizes");
+    }
+}
+
+void batch_add(big_batch& r, big_batch const& a, big_batch const& b) {
+    check_sizes(r, a, b);
+    lane_kernel_table const& k = kernels();
+    scratch_limbs c(TILE);
+    for (size_t i = 0; i < r.size(); i += TILE) {
+        size_t t = std::min(TILE, r.size() - i);
+        k.add(tile(r, i), tile(a, i), tile(b, i), t, c.data());
+    }
+}
+
+void batch_mul(big_batch& r, big_batch const& a, big_batch const& b) {
+    check_sizes(r, a, b);
+    if (&r == &a || &r == &b) {
+        big_batch res(r.size(), r.limbs());
+        batch_mul(res, a, b);
+        r = res;
+        return;
+    }
+    lane_kernel_table const& k = kernels();
+    scratch_limbs c(TILE);
+    for (size_t i = 0; i < r.size(); i += TILE) {
+        size_t t = std::min(TILE, r.size() - i);
+        k.mul(tile(r, i), tile(a, i), tile(b, i), t, c.data());
+    }
+}
+
+void batch_mod(big_batch& r, big_batch const& a, big_integer const& m) {
+    big_integer_view mv(m);
+    size_t n = mv.len;
+    if (m <= 0 || r.limbs() < n) {
+        throw std::invalid_argument("bad modulus for the batch");
+    }
+    if (r.size() != a.size()) {
+        throw std::invalid_argument("batches of different sizes");
+    }
+    // Barrett with base 2^32 (HAC 14.42): mu = floor(2^(64n) / m), and a
+    // window x < m * 2^(32n) is reduced by q = x / 2^(32(n-1)) * mu / 2^(32(n+1)),
+    // x - q * m over n + 1 limbs and at most two more subtractions of m.
+    big_integer mu = (big_integer(1) << static_cast<int>(64 * n)) / m;
+    big_integer_view muv(mu);
+    scratch_limbs mpad(n + 1);
+    std::copy(mv.num, mv.num + n, mpad.data());
+    mpad[n] = 0;
+
+    size_t ql = n + 1 + muv.len;
+    scratch_limbs c(2 * TILE), xs(2 * n * TILE), qs(ql * TILE), rs((n + 1) * TILE);
+    lane_kernel_table const& k = kernels();
+    size_t chunks = (a.limbs() + n - 1) / n;
+    for (size_t i = 0; i < r.size(); i += TILE) {
+        size_t t = std::min(TILE, r.size() - i);
+        out_rows x{xs.data(), t, 2 * n};
+        out_rows low{xs.data(), t, n + 1};
+        out_rows high{x.row(n - 1), t, n + 1};
+        out_rows q{qs.data(), t, ql};
+        out_rows q3{q.row(n + 1), t, n + 1};
+        out_rows qm{rs.data(), t, n + 1};
+        in_rows src = tile(a, i);
+        for (size_t l = n; l < 2 * n; l++) {
+            std::fill(x.row(l), x.row(l) + t, 0);
+        }
+        // top chunk first; the running remainder sits in the upper n rows
+        for (size_t ch = chunks; ch-- > 0;) {
+            for (size_t l = 0; l < n; l++) {
+                size_t sl = ch * n + l;
+                if (sl < src.limbs) {
+                    std::copy(src.row(sl), src.row(sl) + t, x.row(l));
+                } else {
+                    std::fill(x.row(l), x.row(l) + t, 0);
+                }
+            }
+            k.mul_const(q, high, muv.num, muv.len, t, c.data());
+            k.mul_const(qm, q3, mv.num, n, t, c.data());
+            k.sub(low, low, qm, t, c.data());
+            k.cond_sub(low, mpad.data(), t, c.data());
+            k.cond_sub(low, mpad.data(), t, c.data());
+            for (size_t l = 0; l < n; l++) {
+                std::copy(x.row(l), x.row(l) + t, x.row(n + l));
+            }
+        }
+        out_rows dst = tile(r, i);
+        for (size_t l = 0; l < dst.limbs; l++) {
+            if (l < n) {
+                std::copy(x.row(n + l), x.row(n + l) + t, dst.row(l));
+            } else {
+                std::fill(dst.row(l), dst.row(l) + t, 0);
+            }
+        }
+    }
+}
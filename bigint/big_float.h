@@ -0,0 +1,89 @@
+#ifndef BIG_FLOAT_H
+#define BIG_FLOAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "big_integer.h"
+
+// mantissa * 2^exponent with |mantissa| < 2^precision. Every result is cut
+// to the larger precision of its operands by truncation toward zero, so it
+// is off by less than one unit in the last place, or a few for the Newton
+// paths of division and sqrt.
+class big_float
+{
+public:
+    // 0 at float_precision() bits
+    big_float();
+    big_float(int a);
+    explicit big_float(big_integer const& mantissa, int64_t exponent = 0, size_t precision = 0);
+    // decimal "[-]ddd[.ddd][e[-]ddd]"; throws std::invalid_argument without
+    // any digit
+    explicit big_float(std::string const& str, size_t precision = 0);
+
+    big_integer const& mantissa() const;
+    int64_t exponent() const;
+    size_t precision() const;
+    // rounds if the precision goes down; 0 means float_precision()
+    void set_precision(size_t precision);
+
+    big_float& operator+=(big_float const& rhs);
+    big_float& operator-=(big_float const& rhs);
+    big_float& operator*=(big_float const& rhs);
+    // throws std::invalid_argument when dividing by zero
+    big_float& operator/=(big_float const& rhs);
+
+    big_float operator+() const;
+    big_float operator-() const;
+
+    int sign() const;
+
+    friend int compare(big_float const& a, big_float const& b);
+
+private:
+    void round();
+
+    big_integer mant;
+    int64_t exp;
+    size_t prec;
+};
+
+// Precision in bits of the floats built without one; 256 by default.
+void set_float_precision(size_t bits);
+size_t float_precision();
+
+// Operands of at least this many bits are divided through a Newton
+// reciprocal instead of long division.
+void set_newton_div_threshold(size_t bits);
+size_t newton_div_threshold();
+
+big_float operator+(big_float a, big_float const& b);
+big_float operator-(big_float a, big_float const& b);
+big_float operator*(big_float a, big_float const& b);
+big_float operator/(big_float a, big_float const& b);
+
+// by Newton iteration on 1 / sqrt(a); throws std::invalid_argument if a < 0
+big_float sqrt(big_float const& a);
+// rounds toward zero
+big_integer trunc(big_float const& a);
+
+// -1, 0 or 1
+int compare(big_float const& a, big_float const& b);
+
+bool operator==(big_float const& a, big_float const& b);
+bool operator!=(big_float const& a, big_float const& b);
+bool operator<(big_float const& a, big_float const& b);
+bool operator>(big_float const& a, big_float const& b);
+bool operator<=(big_float const& a, big_float const& b);
+bool operator>=(big_float const& a, big_float const& b);
+
+// rounded to digits significant digits, as "d.ddd" followed by
+// "e<exponent>" unless the exponent is 0; without digits, as many as the
+// precision holds
+std::string to_string(big_float const& a, size_t digits);
+std::string to_string(big_float const& a);
+std::ostream& operator<<(std::ostream& s, big_float const& a);
+
+#endif // BIG_FLOAT_H
@@ -1,13 +1,23 @@
 #include "big_integer.h"
+#include "limb_kernels.h"
+#include "scratch_arena.h"
+#include "task_pool.h"
+#include "limb_resource.h"
 
 #include <cstring>
 #include <stdexcept>
 #include <cstdint>
 #include <algorithm>
+#include <limits>
+#include <atomic>
 
 static const uint32_t SHIFT = 32;
 static const uint32_t HALF_SHIFT = SHIFT / 2;
 static const uint32_t HALF_ONES = (1ll << HALF_SHIFT) - 1;
+static const size_t KARATSUBA_THRESHOLD = 100000;
+static std::atomic<size_t> parallel_cutoff(1024);
+
+int8_t compare(big_integer_view a, big_integer_view b);
 
 big_integer::big_integer() : num({0}), sign(false) {}
 
@@ -34,6 +44,11 @@ big_integer::big_integer(std::string const& str) {
     *this = res;
 }
 
+big_integer::big_integer(big_integer_view v) : sign(v.sign) {
+    num.resize(v.len);
+    std::copy(v.num, v.num + v.len, &num[0]);
+}
+
 big_integer::~big_integer() = default;
 
 big_integer& big_integer::operator=(big_integer const& other) = default;
@@ -50,19 +65,69 @@ uint32_t subInt(uint32_t &a, uint32_t b) {
     return b != 0 && a >= c;
 }
 
+bool is_zero(big_integer_view a) {
+    return a.len == 1 && a.num[0] == 0;
+}
+
+big_integer_view magnitude(big_integer_view a) {
+    a.sign = false;
+    return a;
+}
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Values of at most two limbs, which my_vector keeps inline, are worked on
+// as native integers; the result only leaves the inline storage when it
+// needs more than two limbs.
+bool is_small(big_integer_view a) {
+    return a.len <= 2;
+}
+
+uint64_t small_value(big_integer_view a) {
+    return a.len == 1 ? a.num[0] : (static_cast<uint64_t>(a.num[1]) << SHIFT) | a.num[0];
+}
+
+void set_small(big_integer& a, bool sign, uint128_t mag) {
+    size_t len = 1;
+    while (len < 4 && (mag >> (SHIFT * len)) != 0) {
+        len++;
+    }
+    a.num.resize(len);
+    for (size_t i = 0; i < len; i++) {
+        a.num[i] = static_cast<uint32_t>(mag >> (SHIFT * i));
+    }
+    a.sign = (sign && mag != 0);
+}
+
 big_integer& big_integer::operator+=(big_integer const& rhs) {
-    if (rhs == 0) {
+    return *this += big_integer_view(rhs);
+}
+
+big_integer& big_integer::operator+=(big_integer_view rhs) {
+    if (is_small(*this) && is_small(rhs)) {
+        uint64_t x = small_value(*this), y = small_value(rhs);
+        if (sign == rhs.sign) {
+            set_small(*this, sign, static_cast<uint128_t>(x) + y);
+        } else if (x >= y) {
+            set_small(*this, sign, x - y);
+        } else {
+            set_small(*this, rhs.sign, y - x);
+        }
+        return *this;
+    }
+    if (is_zero(rhs)) {
         return *this;
     }
     if (sign == rhs.sign) {
-        uint32_t carry = 0;
-        for (size_t i = 0; i < rhs.num.size() || carry; i++) {
-            if (i == num.size()) {
-                num.push_back(0);
-            }
-            uint32_t newCarry = addInt(num[i], (i < rhs.num.size() ? rhs.num[i] : 0));
-            newCarry += addInt(num[i], carry);
-            carry = newCarry;
+        if (num.size() < rhs.len) {
+            num.resize(rhs.len);
+        }
+        uint32_t carry = add_n(&num[0], &num[0], rhs.num, rhs.len);
+        for (size_t i = rhs.len; i < num.size() && carry; i++) {
+            carry = addInt(num[i], carry);
+        }
+        if (carry) {
+            num.push_back(carry);
         }
     } else {
         *this -= -rhs;
@@ -73,7 +138,14 @@ big_integer& big_integer::operator+=(big_integer const& rhs) {
 
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
-    if (rhs == 0) {
+    return *this -= big_integer_view(rhs);
+}
+
+big_integer& big_integer::operator-=(big_integer_view rhs) {
+    if (is_small(*this) && is_small(rhs)) {
+        return *this += -rhs;
+    }
+    if (is_zero(rhs)) {
         return *this;
     }
     if (sign == rhs.sign) {
@@ -81,15 +153,13 @@ big_integer& big_integer::operator-=(big_integer const& rhs) {
             return *this = big_integer(0);
         }
         if ((*this < rhs) != sign) {
-            big_integer tmp = rhs;
+            big_integer tmp(rhs);
             tmp -= *this;
             return *this = -tmp;
         }
-        uint32_t carry = 0;
-        for (size_t i = 0; i < rhs.num.size() || carry; i++) {
-            uint32_t newCarry = subInt(num[i], (i < rhs.num.size() ? rhs.num[i] : 0));
-            newCarry += subInt(num[i], carry);
-            carry = newCarry;
+        uint32_t carry = sub_n(&num[0], &num[0], rhs.num, rhs.len);
+        for (size_t i = rhs.len; carry; i++) {
+            carry = subInt(num[i], carry);
         }
     } else {
         *this += -rhs;
@@ -119,198 +189,377 @@ big_integer abs(big_integer const& rhs) {
     return res;
 }
 
-big_integer& big_integer::operator*=(big_integer const& rhs) {
-    size_t n = (std::max(num.size(), rhs.num.size()) + 1) / 2;
-    if (n < 100000) {   
-        big_integer res;
-        res.num.resize(num.size() + rhs.num.size() + 1);
-        res.sign = (sign != rhs.sign);
-        for (size_t i = 0; i < num.size(); i++) {
-            uint32_t carry = 0;
-            for (size_t j = 0; j < rhs.num.size() || carry; j++) {
-                if (j == rhs.num.size()) {
-                    res.num[i + j] = carry;
-                    break;
-                }
-                std::pair<uint32_t, uint32_t> par = mul(num[i], rhs.num[j]);
-                par.first += addInt(par.second, carry);
-                carry = par.first;
-                carry += addInt(res.num[i + j], par.second);
-            }
+void set_mul_threads(size_t threads) {
+    task_pool::global().set_threads(threads);
+}
+
+size_t mul_threads() {
+    return task_pool::global().threads();
+}
+
+void set_parallel_mul_cutoff(size_t limbs) {
+    parallel_cutoff = std::max<size_t>(limbs, 1);
+}
+
+size_t parallel_mul_cutoff() {
+    return parallel_cutoff;
+}
+
+// r[0..m + n) = a[0..m) * b[0..n)
+void mul_rows(uint32_t* r, uint32_t const* a, size_t m, uint32_t const* b, size_t n) {
+    r[n] = mul_1(r, b, n, a[0]);
+    for (size_t i = 1; i < m; i++) {
+        r[i + n] = addmul_1(r + i, b, n, a[i]);
+    }
+}
+
+// r[0..a.len + b.len) = |a| * |b|
+void mul_limbs(uint32_t* r, big_integer_view a, big_integer_view b) {
+    if (a.len > b.len) {
+        return mul_limbs(r, b, a);
+    }
+    size_t n = b.len;
+    size_t parts = a.len / parallel_cutoff;
+    if (parts >= 2) {
+        parts = std::min(parts, mul_threads());
+    }
+    if (parts < 2) {
+        mul_rows(r, a.num, a.len, b.num, n);
+        return;
+    }
+    // slices of a times b; the first goes straight to r, the others to
+    // scratch, and they are summed afterwards
+    size_t step = (a.len + parts - 1) / parts;
+    parts = (a.len + step - 1) / step;
+    scratch_limbs rest((parts - 1) * (step + n));
+    task_pool::global().run(parts, [&](size_t k) {
+        size_t lo = k * step;
+        uint32_t* out = (k == 0 ? r : rest.data() + (k - 1) * (step + n));
+        mul_rows(out, a.num + lo, std::min(step, a.len - lo), b.num, n);
+    });
+    std::fill(r + step + n, r + a.len + n, 0);
+    for (size_t k = 1; k < parts; k++) {
+        size_t lo = k * step;
+        size_t len = std::min(step, a.len - lo) + n;
+        uint32_t carry = add_n(r + lo, r + lo, rest.data() + (k - 1) * (step + n), len);
+        for (size_t i = lo + len; i < a.len + n && carry; i++) {
+            carry = addInt(r[i], carry);
         }
-        *this = res;
-        remFrontZero();
+    }
+}
+
+void mul_into(big_integer& res, big_integer_view a, big_integer_view b) {
+    res.num.resize(a.len + b.len);
+    res.sign = (a.sign != b.sign);
+    mul_limbs(&res.num[0], a, b);
+    res.remFrontZero();
+}
+
+void sqr_into(big_integer& res, big_integer const& a) {
+    size_t n = a.num.size();
+    res.num.resize(0);
+    res.num.resize(2 * n);
+    res.sign = false;
+    for (size_t i = 0; i + 1 < n; i++) {
+        res.num[i + n] = addmul_1(&res.num[2 * i + 1], &a.num[i + 1], n - i - 1, a.num[i]);
+    }
+    uint32_t top = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        uint32_t next = res.num[i] >> (SHIFT - 1);
+        res.num[i] = (res.num[i] << 1) | top;
+        top = next;
+    }
+    uint32_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        std::pair<uint32_t, uint32_t> par = mul(a.num[i], a.num[i]);
+        uint32_t c = addInt(res.num[2 * i], par.second);
+        c += addInt(res.num[2 * i], carry);
+        par.first += c;
+        carry = addInt(res.num[2 * i + 1], par.first);
+    }
+    res.remFrontZero();
+}
+
+big_integer& big_integer::operator*=(big_integer const& rhs) {
+    return *this *= big_integer_view(rhs);
+}
+
+big_integer& big_integer::operator*=(big_integer_view rhs) {
+    if (is_small(*this) && is_small(rhs)) {
+        set_small(*this, sign != rhs.sign, static_cast<uint128_t>(small_value(*this)) * small_value(rhs));
         return *this;
     }
-    
-    n *= SHIFT;
-    big_integer a = *this >> n;
-    big_integer c = rhs >> n;
-    big_integer b = *this - (a << n);
-    big_integer d = rhs - (c << n);
-    big_integer ac = a * c;
-    big_integer bd = b * d;
-    big_integer abcd = (a + b) * (c + d);
-    big_integer mid = abcd - ac - bd;
-    *this = (ac << n * 2) + (mid << n) + bd;
+    if ((std::max(num.size(), rhs.len) + 1) / 2 >= KARATSUBA_THRESHOLD) {
+        return *this = *this * rhs;
+    }
+    size_t len = num.size() + rhs.len;
+    scratch_limbs prod(len);
+    mul_limbs(prod.data(), *this, rhs);
+    num.resize(len);
+    std::copy(prod.data(), prod.data() + len, &num[0]);
+    sign = (sign != rhs.sign);
     remFrontZero();
     return *this;
 }
 
 uint32_t div64(uint64_t a, uint64_t b, uint64_t d) {
     uint64_t c = (a << SHIFT) + b;
-    return c / d;
+    return std::min<uint64_t>(c / d, UINT32_MAX);
 }
 
-bool smaller_shift(big_integer& a, big_integer& b, size_t k, size_t l) {
-    if (a.num.size() - k > b.num.size() - l) {
-        return false;
+// q = a / b and r = a % b, rounding toward zero like the built-in operators.
+// Either output may be null, and either may be the object a or b views.
+void divmod_into(big_integer* q, big_integer* r, big_integer_view a, big_integer_view b) {
+    if (is_zero(b)) {
+        throw std::invalid_argument("Division by zero!");
+    }
+    bool q_sign = (a.sign != b.sign), r_sign = a.sign;
+    if (is_small(a) && is_small(b)) {
+        uint64_t x = small_value(a), y = small_value(b);
+        if (q != nullptr) {
+            set_small(*q, q_sign, x / y);
+        }
+        if (r != nullptr) {
+            set_small(*r, r_sign, x % y);
+        }
+        return;
+    }
+    if (compare(magnitude(a), magnitude(b)) < 0) {
+        if (r != nullptr) {
+            *r = big_integer(a);
+        }
+        if (q != nullptr) {
+            *q = big_integer(0);
+        }
+        return;
+    }
+    size_t n = a.len, m = b.len;
+    scratch_limbs u(n + 1), v(m), t(m + 1);
+    uint32_t f = (1ULL << SHIFT) / (b.num[m - 1] + 1ULL);
+    u[n] = mul_1(u.data(), a.num, n, f);
+    mul_1(v.data(), b.num, m, f);
+    if (q != nullptr) {
+        q->num.resize(n - m + 1);
+    }
+    for (size_t j = n - m + 1; j-- > 0;) {
+        uint32_t zdb = div64(u[j + m], u[j + m - 1], v[m - 1]);
+        t[m] = mul_1(t.data(), v.data(), m, zdb);
+        while (cmp_n(u.data() + j, t.data(), m + 1) < 0) {
+            t[m] -= sub_n(t.data(), t.data(), v.data(), m);
+            zdb--;
+        }
+        sub_n(u.data() + j, u.data() + j, t.data(), m + 1);
+        if (q != nullptr) {
+            q->num[j] = zdb;
+        }
+    }
+    if (q != nullptr) {
+        q->sign = q_sign;
+        q->remFrontZero();
     }
-    for (ptrdiff_t i = b.num.size()-1; i >= 0; --i) {
-        size_t q = i - l + k;
-        if (a.num[q] != b.num[i]) {
-            return a.num[q] < b.num[i];
+    if (r != nullptr) {
+        // u holds the remainder times f
+        r->num.resize(m);
+        uint64_t rem = 0;
+        for (size_t i = m; i-- > 0;) {
+            rem = (rem << SHIFT) | u[i];
+            r->num[i] = static_cast<uint32_t>(rem / f);
+            rem %= f;
         }
+        r->sign = r_sign;
+        r->remFrontZero();
     }
-    return false;
 }
 
-void sub_in_div(big_integer& a, big_integer const& b, size_t k, size_t l) {
-    uint32_t carry = 0;
-    for (size_t i = 0; i < b.num.size() || carry; i++) {
-        size_t q = i - l + k;
-        uint32_t newCarry = subInt(a.num[q], carry);
-        newCarry += subInt(a.num[q], (i < b.num.size() ? b.num[i] : 0));
-        carry = newCarry;
+big_integer& big_integer::operator/=(big_integer const& rhs) {
+    return *this /= big_integer_view(rhs);
+}
+
+big_integer& big_integer::operator/=(big_integer_view rhs) {
+    divmod_into(this, nullptr, *this, rhs);
+    return *this;
+}
+
+big_integer& big_integer::operator%=(big_integer const& rhs) {
+    return *this %= big_integer_view(rhs);
+}
+
+big_integer& big_integer::operator%=(big_integer_view rhs) {
+    divmod_into(nullptr, this, *this, rhs);
+    return *this;
+}
+
+big_integer gcd(big_integer_view a, big_integer_view b) {
+    // Euclid over three buffers taking turns, so no step copies a remainder
+    big_integer buf[3] = {big_integer(magnitude(a)), big_integer(magnitude(b)), big_integer()};
+    size_t x = 0, y = 1, r = 2;
+    while (!is_zero(buf[y])) {
+        divmod_into(nullptr, &buf[r], buf[x], buf[y]);
+        size_t t = x;
+        x = y;
+        y = r;
+        r = t;
     }
-    a.remFrontZero();
+    return buf[x];
 }
 
-big_integer& big_integer::operator/=(big_integer const& rhs) {
-    if (rhs == 0) {
+big_integer invmod(big_integer_view a, big_integer_view m) {
+    big_integer mod(magnitude(m));
+    if (mod <= 1) {
+        throw std::invalid_argument("modulus must be greater than 1");
+    }
+    // extended Euclid, keeping only the coefficients of a: t[y] * a = buf[y]
+    big_integer buf[3] = {mod, big_integer(a) % mod, big_integer()};
+    if (buf[1].sign) {
+        buf[1] += mod;
+    }
+    big_integer t[3] = {0, 1, big_integer()};
+    big_integer q;
+    size_t x = 0, y = 1, r = 2;
+    while (!is_zero(buf[y])) {
+        divmod_into(&q, &buf[r], buf[x], buf[y]);
+        t[r] = t[x];
+        q *= t[y];
+        t[r] -= q;
+        size_t tmp = x;
+        x = y;
+        y = r;
+        r = tmp;
+    }
+    if (buf[x] != 1) {
+        throw std::invalid_argument("not invertible");
+    }
+    if (t[x].sign) {
+        t[x] += mod;
+    }
+    return t[x];
+}
+
+// Jebelean's exact division: the quotient comes out limb by limb from the
+// bottom, each limb being the remaining low limb times b^-1 mod 2^32, and
+// only the limbs below the quotient's length are ever looked at.
+big_integer divexact(big_integer_view a, big_integer_view b) {
+    if (is_zero(b)) {
         throw std::invalid_argument("Division by zero!");
     }
-    if (num < rhs.num) {
-        return *this = big_integer(0);
+    if (compare(magnitude(a), magnitude(b)) < 0) {
+        return big_integer(0);
     }
-    big_integer a = *this;
-    big_integer b = rhs;
-    uint32_t f = (1ULL << SHIFT) / (b.num.back() + 1);
-    a *= f;
-    b *= f;
-    big_integer res;
-    bool res_sign = (a.sign != b.sign);
-    a.sign = b.sign = false;
-    size_t n = a.num.size(), m = b.num.size();
-    res.num.resize(n - m + 1);
-    size_t ai = n;
-    for (size_t i = m; i <= n; i++) {
-        ai--;
-        if (ai >= a.num.size()) {
-            res.num[ai - m + 1] = 0;
-            continue;
+    // take out the power of two b has, which a has too, to make b odd
+    size_t z = count_trailing_zeros(b), skip = z / SHIFT, bits = z % SHIFT;
+    size_t n = a.len - skip, m = b.len - skip;
+    scratch_limbs u(n), v(m);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t pair = a.num[skip + i] | (skip + i + 1 < a.len ? static_cast<uint64_t>(a.num[skip + i + 1]) << SHIFT : 0);
+        u[i] = static_cast<uint32_t>(pair >> bits);
+    }
+    for (size_t i = 0; i < m; i++) {
+        uint64_t pair = b.num[skip + i] | (skip + i + 1 < b.len ? static_cast<uint64_t>(b.num[skip + i + 1]) << SHIFT : 0);
+        v[i] = static_cast<uint32_t>(pair >> bits);
+    }
+    while (n > 1 && u[n - 1] == 0) {
+        n--;
+    }
+    while (m > 1 && v[m - 1] == 0) {
+        m--;
+    }
+    big_integer q;
+    q.num.resize(n - m + 1);
+    size_t len = q.num.size();
+    // Newton on 2-adic inverses doubles the correct low bits: 1, 2, 4, ..., 32
+    uint32_t inv = 1;
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - v[0] * inv;
+    }
+    if (m == 1) {
+        uint32_t d = v[0], borrow = 0;
+        for (size_t i = 0; i < len; i++) {
+            uint32_t c = (u[i] < borrow);
+            uint32_t x = (u[i] - borrow) * inv;
+            q.num[i] = x;
+            borrow = static_cast<uint32_t>((static_cast<uint64_t>(x) * d) >> SHIFT) + c;
         }
-        uint32_t zdb = div64((ai + 1 < a.num.size() ? a.num[ai + 1] : 0), a.num[ai], b.num.back());
-        big_integer tmp = b * zdb;
-        while (smaller_shift(a, tmp, ai, m - 1)) {
-            tmp -= b;
-            zdb--;
+    } else {
+        scratch_limbs t(m + 1);
+        for (size_t i = 0; i < len; i++) {
+            uint32_t x = u[i] * inv;
+            q.num[i] = x;
+            size_t w = std::min(m, len - i);
+            t[w] = mul_1(t.data(), v.data(), w, x);
+            if (w < len - i) {
+                w++;
+            }
+            uint32_t borrow = sub_n(u.data() + i, u.data() + i, t.data(), w);
+            for (size_t k = i + w; borrow != 0 && k < len; k++) {
+                borrow = (u[k] == 0);
+                u[k]--;
+            }
         }
-        res.num[ai - m + 1] = zdb;
-        sub_in_div(a, tmp, ai, m - 1);
     }
-    res.sign = res_sign;
-    res.remFrontZero();
-    return *this = res;
-}
-
-big_integer& big_integer::operator%=(big_integer const& rhs) {
-    big_integer res = *this - (*this / rhs) * rhs;
-    res.remFrontZero();
-    return *this = res;
+    q.sign = (a.sign != b.sign);
+    q.remFrontZero();
+    return q;
 }
 
 void neg_inv(big_integer& a) {
     if (!a.sign) {
         return;
     }
-    for (size_t i = 0; i < a.num.size(); i++) {
-        a.num[i] = ~a.num[i];
+    com_n(&a.num[0], &a.num[0], a.num.size());
+    for (size_t i = 0; i < a.num.size() && addInt(a.num[i], 1); i++) {}
+}
+
+// r[0..len) = a in two's complement, len > a.len
+void twos_complement(uint32_t* r, big_integer_view a, size_t len) {
+    std::copy(a.num, a.num + a.len, r);
+    std::fill(r + a.len, r + len, 0);
+    if (a.sign) {
+        com_n(r, r, len);
+        for (size_t i = 0; i < len && ++r[i] == 0; i++) {}
     }
-    a--;
+}
+
+big_integer& bitwise(big_integer& a, big_integer_view b, bool sign,
+                     void (*op)(uint32_t*, uint32_t const*, uint32_t const*, size_t)) {
+    size_t len = std::max(a.num.size(), b.len) + 1;
+    scratch_limbs c(len);
+    twos_complement(c.data(), b, len);
+    a.num.resize(len);
+    neg_inv(a);
+    op(&a.num[0], &a.num[0], c.data(), len);
+    a.sign = sign;
+    neg_inv(a);
+    a.remFrontZero();
+    return a;
 }
 
 big_integer& big_integer::operator&=(big_integer const& rhs) {
-    bool new_sign = (sign & rhs.sign);
-    big_integer c = big_integer(rhs);
-    if (num.size() < c.num.size()) {
-        num.resize(c.num.size());
-    } else {
-        c.num.resize(num.size());
-    }
-    neg_inv(*this);
-    neg_inv(c);
-    for (size_t i = 0; i < num.size(); i++) {
-        num[i] = num[i] & c.num[i];
-    }
-    sign = new_sign;
-    neg_inv(*this);
-    remFrontZero();
-    return *this;
+    return bitwise(*this, rhs, sign & rhs.sign, and_n);
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) {
-    bool new_sign = (sign | rhs.sign);
-    big_integer c = big_integer(rhs);
-    if (num.size() < c.num.size()) {
-        num.resize(c.num.size());
-    } else {
-        c.num.resize(num.size());
-    }
-    neg_inv(*this);
-    neg_inv(c);
-    for (size_t i = 0; i < num.size(); i++) {
-        num[i] = num[i] | c.num[i];
-    }
-    sign = new_sign;
-    neg_inv(*this);
-    remFrontZero();
-    return *this;
+    return bitwise(*this, rhs, sign | rhs.sign, ior_n);
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) {
-    bool new_sign = (sign ^ rhs.sign);
-    big_integer c = big_integer(rhs);
-    if (num.size() < c.num.size()) {
-        num.resize(c.num.size());
-    } else {
-        c.num.resize(num.size());
-    }
-    neg_inv(*this);
-    neg_inv(c);
-    for (size_t i = 0; i < num.size(); i++) {
-        num[i] = num[i] ^ c.num[i];
-    }
-    sign = new_sign;
-    neg_inv(*this);
-    remFrontZero();
-    return *this;
+    return bitwise(*this, rhs, sign ^ rhs.sign, xor_n);
 }
 
 big_integer& big_integer::operator<<=(int rhs) {
     if (rhs < 0) {
         throw std::invalid_argument("negative shift");
     }
+    if (num.size() <= 2 && rhs < 64) {
+        set_small(*this, sign, static_cast<uint128_t>(small_value(*this)) << rhs);
+        return *this;
+    }
     big_integer res;
     res.sign = (*this).sign;
     uint32_t shift = SHIFT - rhs % SHIFT;
     uint32_t start = rhs / SHIFT;
     res.num.resize(num.size() + start + 1);
     for (size_t i = 0; i < num.size(); i++) {
-        uint32_t fir = num[i] >> shift;
-        if (shift == SHIFT) {
-            fir = 0;
-        }
+        uint32_t fir = (shift == SHIFT ? 0 : num[i] >> shift);
         uint32_t sec = num[i] & ((1ll << shift) - 1);
         res.num[i + start] += (sec << (rhs % SHIFT));
         res.num[i + start + 1] += fir;
@@ -323,8 +572,14 @@ big_integer& big_integer::operator>>=(int rhs) {
     if (rhs < 0) {
         throw std::invalid_argument("negative shift");
     }
-    if ((uint32_t)rhs > num.size() * SHIFT) {
-        return *this = 0;
+    if (static_cast<size_t>(rhs) >= num.size() * SHIFT) {
+        return *this = (sign ? -1 : 0);
+    }
+    if (num.size() <= 2) {
+        // rounds toward minus infinity: -m >> k == -((m - 1) >> k) - 1
+        uint64_t x = small_value(*this);
+        set_small(*this, sign, sign ? ((x - 1) >> rhs) + 1 : x >> rhs);
+        return *this;
     }
     big_integer res;
     res.sign = (*this).sign;
@@ -334,7 +589,7 @@ big_integer& big_integer::operator>>=(int rhs) {
     for (size_t i = start; i < num.size(); i++) {
         uint32_t sec = num[i] >> shift;
         uint32_t fir = (i + 1 < num.size() ? num[i + 1] : 0) & ((1ll << shift) - 1);
-        res.num[i - start] = (fir << (SHIFT - shift)) + sec;
+        res.num[i - start] = (shift == 0 ? 0 : fir << (SHIFT - shift)) + sec;
     }
     bool needAdd = ((num[start] & ((1ll << shift) - 1)) > 0);
     for (size_t i = 0; i < start; i++) {
@@ -350,6 +605,232 @@ big_integer& big_integer::operator>>=(int rhs) {
     return *this = res;
 }
 
+uint32_t limb_bits(uint32_t x) {
+    return x == 0 ? 0 : SHIFT - __builtin_clz(x);
+}
+
+size_t pow_window(size_t bits) {
+    static const size_t limits[] = {8, 24, 80, 240};
+    size_t w = 1;
+    while (w <= 4 && bits > limits[w - 1]) {
+        w++;
+    }
+    return w;
+}
+
+void pow_sqr(big_integer& res, big_integer const& a) {
+    if ((a.num.size() + 1) / 2 < KARATSUBA_THRESHOLD) {
+        sqr_into(res, a);
+    } else {
+        res = a * a;
+    }
+}
+
+void pow_mul(big_integer& res, big_integer const& a, big_integer const& b) {
+    if ((std::max(a.num.size(), b.num.size()) + 1) / 2 < KARATSUBA_THRESHOLD) {
+        mul_into(res, a, b);
+    } else {
+        res = a * b;
+    }
+}
+
+big_integer pow(big_integer const& a, uint64_t e) {
+    if (e == 0) {
+        return 1;
+    }
+    if (a == 0) {
+        return 0;
+    }
+    bool res_sign = a.sign && (e & 1);
+    size_t n = a.num.size();
+    size_t bits = (n - 1) * SHIFT + limb_bits(a.num.back());
+    size_t low = 0;
+    while (a.num[low] == 0) {
+        low++;
+    }
+    if (low == n - 1 && (a.num.back() & (a.num.back() - 1)) == 0) {
+        if (bits - 1 > std::numeric_limits<int>::max() / e) {
+            throw std::invalid_argument("pow result too large");
+        }
+        big_integer res = big_integer(1) << static_cast<int>((bits - 1) * e);
+        res.sign = res_sign;
+        return res;
+    }
+    if (bits > std::numeric_limits<size_t>::max() / e) {
+        throw std::invalid_argument("pow result too large");
+    }
+
+    size_t e_bits = 0;
+    while (e_bits < 64 && (e >> e_bits) > 0) {
+        e_bits++;
+    }
+    size_t w = pow_window(e_bits);
+    std::vector<big_integer> table(static_cast<size_t>(1) << (w - 1));
+    table[0] = abs(a);
+    if (w > 1) {
+        big_integer sq;
+        pow_sqr(sq, table[0]);
+        for (size_t k = 1; k < table.size(); k++) {
+            pow_mul(table[k], table[k - 1], sq);
+        }
+    }
+
+    // two preallocated buffers the square-and-multiply steps ping-pong between
+    size_t est = bits * e / SHIFT + 2;
+    big_integer buf[2];
+    buf[0].num.resize(est);
+    buf[1].num.resize(est);
+    size_t cur = 0;
+    bool started = false;
+    ptrdiff_t i = e_bits - 1;
+    while (i >= 0) {
+        if (((e >> i) & 1) == 0) {
+            pow_sqr(buf[cur ^ 1], buf[cur]);
+            cur ^= 1;
+            i--;
+            continue;
+        }
+        ptrdiff_t l = std::max<ptrdiff_t>(i - static_cast<ptrdiff_t>(w) + 1, 0);
+        while (((e >> l) & 1) == 0) {
+            l++;
+        }
+        big_integer const& t = table[((e >> l) & ((1ULL << (i - l + 1)) - 1)) >> 1];
+        if (started) {
+            for (ptrdiff_t s = l; s <= i; s++) {
+                pow_sqr(buf[cur ^ 1], buf[cur]);
+                cur ^= 1;
+            }
+            pow_mul(buf[cur ^ 1], buf[cur], t);
+            cur ^= 1;
+        } else {
+            buf[cur].num.resize(t.num.size());
+            for (size_t k = 0; k < t.num.size(); k++) {
+                buf[cur].num[k] = t.num[k];
+            }
+            started = true;
+        }
+        i = l - 1;
+    }
+    buf[cur].sign = res_sign;
+    return buf[cur];
+}
+
+// A negative a = -m reads as ~(m - 1): below the lowest set bit t of m the
+// bits of a are 0, bit t is 1 and every bit above is the inverse of m's, so
+// none of the queries below has to form m - 1.
+
+size_t count_trailing_zeros(big_integer_view a) {
+    if (is_zero(a)) {
+        throw std::invalid_argument("zero has no set bit");
+    }
+    size_t i = 0;
+    while (a.num[i] == 0) {
+        i++;
+    }
+    return i * SHIFT + __builtin_ctz(a.num[i]);
+}
+
+size_t bit_length(big_integer_view a) {
+    size_t bits = (a.len - 1) * SHIFT + limb_bits(a.num[a.len - 1]);
+    if (a.sign && count_trailing_zeros(a) == bits - 1) {
+        // -2^k needs one bit less than 2^k
+        bits--;
+    }
+    return bits;
+}
+
+static bool magnitude_bit(big_integer_view a, size_t k) {
+    return k / SHIFT < a.len && ((a.num[k / SHIFT] >> (k % SHIFT)) & 1);
+}
+
+bool test_bit(big_integer_view a, size_t k) {
+    if (!a.sign) {
+        return magnitude_bit(a, k);
+    }
+    size_t t = count_trailing_zeros(a);
+    return k == t || (k > t && !magnitude_bit(a, k));
+}
+
+size_t popcount(big_integer_view a) {
+    size_t res = popcount_n(a.num, a.len);
+    if (a.sign) {
+        // m - 1 trades the lowest set bit of m for the t ones below it
+        res += count_trailing_zeros(a) - 1;
+    }
+    return res;
+}
+
+big_integer lowest_set_bit(big_integer_view a) {
+    big_integer res;
+    if (!is_zero(a)) {
+        size_t i = 0;
+        while (a.num[i] == 0) {
+            i++;
+        }
+        res.num.resize(i + 1);
+        res.num[i] = a.num[i] & (~a.num[i] + 1);
+    }
+    return res;
+}
+
+// |a| += 2^k and |a| -= 2^k; the latter needs |a| >= 2^k
+static void add_bit(big_integer& a, size_t k) {
+    size_t i = k / SHIFT;
+    if (a.num.size() <= i) {
+        a.num.resize(i + 1);
+    }
+    uint32_t c = static_cast<uint32_t>(1) << (k % SHIFT);
+    for (; i < a.num.size() && c; i++) {
+        a.num[i] += c;
+        c = (a.num[i] < c);
+    }
+    if (c) {
+        a.num.push_back(c);
+    }
+}
+
+static void sub_bit(big_integer& a, size_t k) {
+    size_t i = k / SHIFT;
+    uint32_t b = static_cast<uint32_t>(1) << (k % SHIFT);
+    for (; b; i++) {
+        uint32_t x = a.num[i];
+        a.num[i] = x - b;
+        b = (x < b);
+    }
+    a.remFrontZero();
+}
+
+// Setting a clear bit adds 2^k to a and clearing a set one subtracts it,
+// which for a negative a moves |a| the other way.
+
+big_integer& set_bit(big_integer& a, size_t k) {
+    if (test_bit(a, k)) {
+        return a;
+    }
+    if (a.sign) {
+        sub_bit(a, k);
+    } else {
+        add_bit(a, k);
+    }
+    return a;
+}
+
+big_integer& clear_bit(big_integer& a, size_t k) {
+    if (!test_bit(a, k)) {
+        return a;
+    }
+    if (a.sign) {
+        add_bit(a, k);
+    } else {
+        sub_bit(a, k);
+    }
+    return a;
+}
+
+big_integer& flip_bit(big_integer& a, size_t k) {
+    return test_bit(a, k) ? clear_bit(a, k) : set_bit(a, k);
+}
+
 big_integer big_integer::operator+() const {
     return *this;
 }
@@ -366,10 +847,9 @@ big_integer big_integer::operator-() const {
 
 big_integer big_integer::operator~() const {
     big_integer res = big_integer(*this);
+    res.num.push_back(0);
     neg_inv(res);
-    for (size_t i = 0; i < res.num.size(); i++) {
-        res.num[i] = ~res.num[i];
-    }
+    com_n(&res.num[0], &res.num[0], res.num.size());
     res.sign = !res.sign;
     neg_inv(res);
     res.remFrontZero();
@@ -436,21 +916,74 @@ big_integer operator>>(big_integer a, int b) {
     return a >>= b;
 }
 
-int8_t compare(big_integer const& a, big_integer const& b) {
+big_integer operator+(big_integer_view a, big_integer_view b) {
+    big_integer res(a);
+    return res += b;
+}
+
+big_integer operator-(big_integer_view a, big_integer_view b) {
+    big_integer res(a);
+    return res -= b;
+}
+
+big_integer operator*(big_integer_view a, big_integer_view b) {
+    size_t n = (std::max(a.len, b.len) + 1) / 2;
+    if (n < KARATSUBA_THRESHOLD) {
+        big_integer res;
+        mul_into(res, a, b);
+        return res;
+    }
+
+    n *= SHIFT;
+    big_integer x(a);
+    big_integer y(b);
+    big_integer a1 = x >> n;
+    big_integer c1 = y >> n;
+    big_integer b1 = x - (a1 << n);
+    big_integer d1 = y - (c1 << n);
+    big_integer ab = a1 + b1;
+    big_integer cd = c1 + d1;
+    big_integer ac, bd, abcd;
+    std::pmr::memory_resource* resource = limb_resource();
+    task_pool::global().run(3, [&](size_t k) {
+        limb_resource_scope scope(resource);
+        if (k == 0) {
+            ac = a1 * c1;
+        } else if (k == 1) {
+            bd = b1 * d1;
+        } else {
+            abcd = ab * cd;
+        }
+    });
+    big_integer mid = abcd - ac - bd;
+    big_integer res = (ac << n * 2) + (mid << n) + bd;
+    res.remFrontZero();
+    return res;
+}
+
+big_integer operator/(big_integer_view a, big_integer_view b) {
+    big_integer res(a);
+    return res /= b;
+}
+
+big_integer operator%(big_integer_view a, big_integer_view b) {
+    big_integer res(a);
+    return res %= b;
+}
+
+int8_t compare(big_integer_view a, big_integer_view b) {
     int8_t sign = a.sign ? -1: 1;
     if (a.sign != b.sign) {
         return sign;
     }
-    if (a.num.size() != b.num.size()) {
-        return (a.num.size() < b.num.size() ? -1 : 1) * sign;
+    if (a.len != b.len) {
+        return (a.len < b.len ? -1 : 1) * sign;
     }
-    for (size_t j = 1; j <= a.num.size(); j++) {
-        size_t i = a.num.size() - j;
-        if (a.num[i] != b.num[i]) {
-            return (a.num[i] < b.num[i] ? -1 : 1) * sign;
-        }
+    if (is_small(a)) {
+        uint64_t x = small_value(a), y = small_value(b);
+        return (x == y ? 0 : x < y ? -1 : 1) * sign;
     }
-    return 0;
+    return cmp_n(a.num, b.num, a.len) * sign;
 }
 
 bool operator==(big_integer const& a, big_integer const& b) {
@@ -477,6 +1010,30 @@ bool operator>=(big_integer const& a, big_integer const& b) {
     return compare(a, b) >= 0;
 }
 
+bool operator==(big_integer_view a, big_integer_view b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_integer_view a, big_integer_view b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_integer_view a, big_integer_view b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) >= 0;
+}
+
 std::string to_string(big_integer const& a) {
     std::string res;
     big_integer x = a;
@@ -487,7 +1044,7 @@ std::string to_string(big_integer const& a) {
     }
     if (res.length() == 0) {
         res = "0";
-    } else if a.sign() {
+    } else if (a.sign) {
         res.push_back('-');
     }
     std::reverse(res.begin(), res.end());
@@ -499,6 +1056,184 @@ std::ostream& operator<<(std::ostream& s, big_integer const& a) {
     return s << to_string(a);
 }
 
+std::string to_string(big_integer_view a) {
+    return to_string(big_integer(a));
+}
+
+std::ostream& operator<<(std::ostream& s, big_integer_view a) {
+    return s << to_string(a);
+}
+
+static const uint32_t ZERO_LIMB = 0;
+
+big_integer_view::big_integer_view(uint32_t const* num, size_t len, bool sign) :
+    num(len == 0 ? &ZERO_LIMB : num),
+    len(len == 0 ? 1 : len),
+    sign(sign) {
+    while (this->len > 1 && this->num[this->len - 1] == 0) {
+        this->len--;
+    }
+    if (this->num[this->len - 1] == 0) {
+        this->sign = false;
+    }
+}
+
+big_integer_view::big_integer_view(big_integer const& a) :
+    num(&a.num[0]),
+    len(a.num.size()),
+    sign(a.sign) {}
+
+big_integer_view big_integer_view::operator-() const {
+    big_integer_view res = *this;
+    res.sign = !is_zero(res) && !sign;
+    return res;
+}
+
+static const uint32_t SIGN_FLAG = 1u << (SHIFT - 1);
+
+size_t serialized_size(big_integer const& a) {
+    return sizeof(uint32_t) * (a.num.size() + 1);
+}
+
+void store_limbs(uint8_t* out, uint32_t const* limbs, size_t n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(out, limbs, n * sizeof(uint32_t));
+#else
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < sizeof(uint32_t); k++) {
+            out[i * sizeof(uint32_t) + k] = static_cast<uint8_t>(limbs[i] >> (8 * k));
+        }
+    }
+#endif
+}
+
+void load_limbs(uint32_t* limbs, uint8_t const* in, size_t n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(limbs, in, n * sizeof(uint32_t));
+#else
+    for (size_t i = 0; i < n; i++) {
+        limbs[i] = 0;
+        for (size_t k = 0; k < sizeof(uint32_t); k++) {
+            limbs[i] |= static_cast<uint32_t>(in[i * sizeof(uint32_t) + k]) << (8 * k);
+        }
+    }
+#endif
+}
+
+void serialize(big_integer const& a, std::vector<uint8_t>& out) {
+    size_t pos = out.size();
+    out.resize(pos + serialized_size(a));
+    uint32_t header = static_cast<uint32_t>(a.num.size()) | (a.sign ? SIGN_FLAG : 0);
+    store_limbs(&out[pos], &header, 1);
+    store_limbs(&out[pos + sizeof(uint32_t)], &a.num[0], a.num.size());
+}
+
+big_integer deserialize(std::vector<uint8_t> const& in, size_t& pos) {
+    if (pos > in.size() || in.size() - pos < sizeof(uint32_t)) {
+        throw std::invalid_argument("truncated big_integer");
+    }
+    uint32_t header;
+    load_limbs(&header, &in[pos], 1);
+    size_t n = header & (SIGN_FLAG - 1);
+    if (n == 0 || (in.size() - pos) / sizeof(uint32_t) - 1 < n) {
+        throw std::invalid_argument("truncated big_integer");
+    }
+    big_integer res;
+    res.num.resize(n);
+    load_limbs(&res.num[0], &in[pos + sizeof(uint32_t)], n);
+    res.sign = (header & SIGN_FLAG) != 0;
+    res.remFrontZero();
+    pos += sizeof(uint32_t) * (n + 1);
+    return res;
+}
+
+void serialize_varint(big_integer const& a, std::vector<uint8_t>& out) {
+    // the bit stream is sign, then the magnitude from its lowest bit
+    uint64_t acc = a.sign;
+    size_t acc_bits = 1;
+    size_t n = a.num.size();
+    while (n > 1 && a.num[n - 1] == 0) {
+        n--;
+    }
+    size_t i = 0;
+    while (true) {
+        if (acc_bits < 7 && i < n) {
+            acc |= static_cast<uint64_t>(a.num[i++]) << acc_bits;
+            acc_bits += SHIFT;
+        }
+        uint8_t byte = acc & 0x7F;
+        acc >>= 7;
+        acc_bits = (acc_bits > 7 ? acc_bits - 7 : 0);
+        bool more = (acc != 0 || i < n);
+        out.push_back(more ? (byte | 0x80) : byte);
+        if (!more) {
+            break;
+        }
+    }
+}
+
+big_integer deserialize_varint(std::vector<uint8_t> const& in, size_t& pos) {
+    big_integer res;
+    res.num.resize(0);
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    bool first = true;
+    bool sign = false;
+    while (true) {
+        if (pos >= in.size()) {
+            throw std::invalid_argument("truncated big_integer");
+        }
+        uint8_t byte = in[pos++];
+        acc |= static_cast<uint64_t>(byte & 0x7F) << acc_bits;
+        acc_bits += 7;
+        if (first) {
+            sign = acc & 1;
+            acc >>= 1;
+            acc_bits--;
+            first = false;
+        }
+        if (acc_bits >= SHIFT) {
+            res.num.push_back(static_cast<uint32_t>(acc));
+            acc >>= SHIFT;
+            acc_bits -= SHIFT;
+        }
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    res.num.push_back(static_cast<uint32_t>(acc));
+    res.sign = sign;
+    res.remFrontZero();
+    return res;
+}
+
+std::vector<uint8_t> serialize_all(std::vector<big_integer> const& values) {
+    size_t total = 0;
+    for (big_integer const& v : values) {
+        total += serialized_size(v);
+    }
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    for (big_integer const& v : values) {
+        serialize(v, out);
+    }
+    return out;
+}
+
+std::vector<big_integer> deserialize_all(std::vector<uint8_t> const& in) {
+    std::vector<big_integer> res;
+    size_t pos = 0;
+    while (pos < in.size()) {
+        res.push_back(deserialize(in, pos));
+    }
+    return res;
+}
+
+size_t std::hash<big_integer>::operator()(big_integer const& a) const {
+    uint64_t h = hash_n(&a.num[0], a.num.size());
+    return static_cast<size_t>(a.sign ? ~h : h);
+}
+
 
 void big_integer::remFrontZero() {
     while (num.size() > (size_t)1 && num.back() == 0) {
@@ -0,0 +1,54 @@
+#include "big_random.h"
+
+#include <stdexcept>
+
+big_random& big_random::local() {
+    static thread_local big_random rng;
+    return rng;
+}
+
+big_random::big_random(uint64_t seed) : engine(seed) {}
+
+void big_random::seed(uint64_t seed) {
+    engine.seed(seed);
+}
+
+void big_random::fill(uint32_t* r, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64_t x = engine();
+        r[i] = static_cast<uint32_t>(x);
+        r[i + 1] = static_cast<uint32_t>(x >> 32);
+    }
+    if (i < n) {
+        r[i] = static_cast<uint32_t>(engine());
+    }
+}
+
+big_integer big_random::bits(size_t k) {
+    big_integer res;
+    if (k == 0) {
+        return res;
+    }
+    size_t n = (k + 31) / 32;
+    res.num.resize(n);
+    fill(&res.num[0], n);
+    if (k % 32 != 0) {
+        res.num[n - 1] &= (static_cast<uint32_t>(1) << (k % 32)) - 1;
+    }
+    res.remFrontZero();
+    return res;
+}
+
+big_integer big_random::below(big_integer_view m) {
+    if (m.sign || (m.len == 1 && m.num[0] == 0)) {
+        throw std::invalid_argument("random bound must be positive");
+    }
+    // a draw of bit_length(m) bits is below m with probability over 1/2
+    size_t k = bit_length(m);
+    big_integer res;
+    do {
+        res = bits(k);
+    } while (res >= m);
+    return res;
+}
@@ -0,0 +1,229 @@
+#include "big_rational.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <stdexcept>
+
+static std::atomic<size_t> reduce_threshold(16);
+
+void set_rational_reduce_threshold(size_t limbs) {
+    reduce_threshold = limbs;
+}
+
+size_t rational_reduce_threshold() {
+    return reduce_threshold;
+}
+
+big_rational::big_rational() : num(0), den(1), reduced_limbs(0), reduced(true) {}
+
+big_rational::big_rational(int a) : num(a), den(1), reduced_limbs(0), reduced(true) {}
+
+big_rational::big_rational(big_integer const& n) : num(n), den(1), reduced_limbs(0), reduced(true) {}
+
+big_rational::big_rational(big_integer const& n, big_integer const& d) : num(n), den(d), reduced_limbs(0), reduced(false) {
+    if (den == 0) {
+        throw std::invalid_argument("zero denominator");
+    }
+    if (den.sign) {
+        den.sign = false;
+        num = -num;
+    }
+}
+
+static big_rational parse(std::string const& str) {
+    size_t slash = str.find('/');
+    if (slash == std::string::npos) {
+        return big_rational(big_integer(str));
+    }
+    return big_rational(big_integer(str.substr(0, slash)), big_integer(str.substr(slash + 1)));
+}
+
+big_rational::big_rational(std::string const& str) : big_rational(parse(str)) {}
+
+big_integer const& big_rational::numerator() {
+    normalize();
+    return num;
+}
+
+big_integer const& big_rational::denominator() {
+    normalize();
+    return den;
+}
+
+void big_rational::normalize() {
+    if (reduced) {
+        return;
+    }
+    if (den != 1) {
+        big_integer g = gcd(num, den);
+        if (g != 1) {
+            num = divexact(num, g);
+            den = divexact(den, g);
+        }
+    }
+    reduced_limbs = num.num.size() + den.num.size();
+    reduced = true;
+}
+
+// every operation that changes the fraction ends here
+void big_rational::maybe_normalize() {
+    reduced = false;
+    size_t limbs = num.num.size() + den.num.size();
+    if (limbs > std::max(rational_reduce_threshold(), 2 * reduced_limbs)) {
+        normalize();
+    }
+}
+
+// n1/d1 + n/d = (n1 * d + n * d1) / (d1 * d). The cross term is a local:
+// a cache kept across calls could hold limbs from a limb_resource_scope
+// that has since ended.
+void big_rational::add(big_integer const& n, big_integer const& d, bool negate) {
+    if (den == d) {
+        if (negate) {
+            num -= n;
+        } else {
+            num += n;
+        }
+    } else {
+        big_integer t = n * den;
+        if (d != 1) {
+            num *= d;
+            den *= d;
+        }
+        if (negate) {
+            num -= t;
+        } else {
+            num += t;
+        }
+    }
+    maybe_normalize();
+}
+
+big_rational& big_rational::operator+=(big_rational const& rhs) {
+    add(rhs.num, rhs.den, false);
+    return *this;
+}
+
+big_rational& big_rational::operator-=(big_rational const& rhs) {
+    add(rhs.num, rhs.den, true);
+    return *this;
+}
+
+big_rational& big_rational::operator*=(big_rational const& rhs) {
+    num *= rhs.num;
+    if (rhs.den != 1) {
+        den *= rhs.den;
+    }
+    maybe_normalize();
+    return *this;
+}
+
+big_rational& big_rational::operator/=(big_rational const& rhs) {
+    if (rhs.num == 0) {
+        throw std::invalid_argument("Division by zero!");
+    }
+    if (this == &rhs) {
+        return *this = 1;
+    }
+    num *= rhs.den;
+    den *= rhs.num;
+    if (den.sign) {
+        den.sign = false;
+        num = -num;
+    }
+    maybe_normalize();
+    return *this;
+}
+
+big_rational& big_rational::add_mul(big_rational const& a, big_rational const& b) {
+    add(a.num * b.num, a.den * b.den, false);
+    return *this;
+}
+
+big_rational& big_rational::sub_mul(big_rational const& a, big_rational const& b) {
+    add(a.num * b.num, a.den * b.den, true);
+    return *this;
+}
+
+big_rational big_rational::operator+() const {
+    return *this;
+}
+
+big_rational big_rational::operator-() const {
+    big_rational r = *this;
+    r.num = -r.num;
+    return r;
+}
+
+int big_rational::sign() const {
+    if (num == 0) {
+        return 0;
+    }
+    return num.sign ? -1 : 1;
+}
+
+big_rational operator+(big_rational a, big_rational const& b) {
+    return a += b;
+}
+
+big_rational operator-(big_rational a, big_rational const& b) {
+    return a -= b;
+}
+
+big_rational operator*(big_rational a, big_rational const& b) {
+    return a *= b;
+}
+
+big_rational operator/(big_rational a, big_rational const& b) {
+    return a /= b;
+}
+
+int compare(big_rational const& a, big_rational const& b) {
+    int sa = a.sign(), sb = b.sign();
+    if (sa != sb || sa == 0) {
+        return sa < sb ? -1 : (sa > sb ? 1 : 0);
+    }
+    if (a.den == b.den) {
+        return a.num < b.num ? -1 : (a.num == b.num ? 0 : 1);
+    }
+    big_integer l = big_integer_view(a.num) * big_integer_view(b.den);
+    big_integer r = big_integer_view(b.num) * big_integer_view(a.den);
+    return l < r ? -1 : (l == r ? 0 : 1);
+}
+
+bool operator==(big_rational const& a, big_rational const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_rational const& a, big_rational const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_rational const& a, big_rational const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_rational const& a, big_rational const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_rational const& a, big_rational const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_rational const& a, big_rational const& b) {
+    return compare(a, b) >= 0;
+}
+
+std::string to_string(big_rational const& a) {
+    big_rational r = a;
+    if (r.denominator() == 1) {
+        return to_string(r.numerator());
+    }
+    return to_string(r.numerator()) + "/" + to_string(r.denominator());
+}
+
+std::ostream& operator<<(std::ostream& s, big_rational const& a) {
+    return s << to_string(a);
+}
@@ -0,0 +1,397 @@
+#ifndef BIG_UINT_H
+#define BIG_UINT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "big_integer.h"
+
+// Fixed-width integer with Bits / 32 inline little-endian limbs.
+// Arithmetic wraps modulo 2^Bits; the signed flavour uses two's complement
+// and rounds division towards zero, like big_integer.
+template<size_t Bits, bool Signed>
+struct big_fixed
+{
+    static_assert(Bits > 0 && Bits % 32 == 0, "width must be a positive multiple of 32 bits");
+    static constexpr size_t LIMBS = Bits / 32;
+    using limbs_t = std::array<uint32_t, LIMBS>;
+
+    limbs_t num;
+
+    constexpr big_fixed() : num() {}
+
+    constexpr big_fixed(int a) : num() {
+        num[0] = static_cast<uint32_t>(a);
+        for (size_t i = 1; i < LIMBS; i++) {
+            num[i] = (a < 0 ? UINT32_MAX : 0);
+        }
+    }
+
+    constexpr big_fixed(unsigned int a) : num() {
+        num[0] = a;
+    }
+
+    explicit big_fixed(big_integer const& a) : num() {
+        for (size_t i = 0; i < LIMBS && i < a.num.size(); i++) {
+            num[i] = a.num[i];
+        }
+        if (a.sign) {
+            *this = -*this;
+        }
+    }
+
+    explicit big_fixed(std::string const& str) : num() {
+        bool neg = (!str.empty() && str[0] == '-');
+        for (size_t i = neg; i < str.size(); i++) {
+            mul_1(num, 10, static_cast<uint32_t>(str[i] - '0'));
+        }
+        if (neg) {
+            *this = -*this;
+        }
+    }
+
+    explicit operator big_integer() const {
+        big_fixed mag = (is_negative() ? -*this : *this);
+        big_integer res;
+        res.num.resize(LIMBS);
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.num[i] = mag.num[i];
+        }
+        res.remFrontZero();
+        return is_negative() ? -res : res;
+    }
+
+    constexpr bool is_negative() const {
+        return Signed && (num[LIMBS - 1] >> 31) != 0;
+    }
+
+    constexpr big_fixed& operator+=(big_fixed const& rhs) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += static_cast<uint64_t>(num[i]) + rhs.num[i];
+            num[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator-=(big_fixed const& rhs) {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t cur = static_cast<uint64_t>(num[i]) - rhs.num[i] - borrow;
+            num[i] = static_cast<uint32_t>(cur);
+            borrow = static_cast<uint32_t>(cur >> 63);
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator*=(big_fixed const& rhs) {
+        limbs_t res = {};
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < LIMBS; j++) {
+                carry += static_cast<uint64_t>(num[i]) * rhs.num[j] + res[i + j];
+                res[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+        }
+        num = res;
+        return *this;
+    }
+
+    constexpr big_fixed& operator/=(big_fixed const& rhs) {
+        limbs_t q = {}, r = {};
+        signed_divmod(*this, rhs, q, r);
+        num = q;
+        return *this;
+    }
+
+    constexpr big_fixed& operator%=(big_fixed const& rhs) {
+        limbs_t q = {}, r = {};
+        signed_divmod(*this, rhs, q, r);
+        num = r;
+        return *this;
+    }
+
+    constexpr big_fixed& operator&=(big_fixed const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            num[i] &= rhs.num[i];
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator|=(big_fixed const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            num[i] |= rhs.num[i];
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator^=(big_fixed const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            num[i] ^= rhs.num[i];
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator<<=(int rhs) {
+        if (rhs < 0) {
+            throw std::invalid_argument("negative shift");
+        }
+        size_t start = static_cast<size_t>(rhs) / 32;
+        uint32_t shift = rhs % 32;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint64_t cur = (i >= start ? static_cast<uint64_t>(num[i - start]) << 32 : 0);
+            if (i >= start + 1) {
+                cur |= num[i - start - 1];
+            }
+            num[i] = static_cast<uint32_t>((cur << shift) >> 32);
+        }
+        return *this;
+    }
+
+    constexpr big_fixed& operator>>=(int rhs) {
+        if (rhs < 0) {
+            throw std::invalid_argument("negative shift");
+        }
+        uint32_t fill = (is_negative() ? UINT32_MAX : 0);
+        size_t start = static_cast<size_t>(rhs) / 32;
+        uint32_t shift = rhs % 32;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t lo = (i + start < LIMBS ? num[i + start] : fill);
+            uint64_t hi = (i + start + 1 < LIMBS ? num[i + start + 1] : fill);
+            num[i] = static_cast<uint32_t>(((hi << 32) | lo) >> shift);
+        }
+        return *this;
+    }
+
+    constexpr big_fixed operator+() const {
+        return *this;
+    }
+
+    constexpr big_fixed operator-() const {
+        big_fixed res = ~*this;
+        return ++res;
+    }
+
+    constexpr big_fixed operator~() const {
+        big_fixed res;
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.num[i] = ~num[i];
+        }
+        return res;
+    }
+
+    constexpr big_fixed& operator++() {
+        for (size_t i = 0; i < LIMBS && ++num[i] == 0; i++) {}
+        return *this;
+    }
+
+    constexpr big_fixed operator++(int) {
+        big_fixed r = *this;
+        ++*this;
+        return r;
+    }
+
+    constexpr big_fixed& operator--() {
+        for (size_t i = 0; i < LIMBS && num[i]-- == 0; i++) {}
+        return *this;
+    }
+
+    constexpr big_fixed operator--(int) {
+        big_fixed r = *this;
+        --*this;
+        return r;
+    }
+
+    friend constexpr big_fixed operator+(big_fixed a, big_fixed const& b) { return a += b; }
+    friend constexpr big_fixed operator-(big_fixed a, big_fixed const& b) { return a -= b; }
+    friend constexpr big_fixed operator*(big_fixed a, big_fixed const& b) { return a *= b; }
+    friend constexpr big_fixed operator/(big_fixed a, big_fixed const& b) { return a /= b; }
+    friend constexpr big_fixed operator%(big_fixed a, big_fixed const& b) { return a %= b; }
+
+    friend constexpr big_fixed operator&(big_fixed a, big_fixed const& b) { return a &= b; }
+    friend constexpr big_fixed operator|(big_fixed a, big_fixed const& b) { return a |= b; }
+    friend constexpr big_fixed operator^(big_fixed a, big_fixed const& b) { return a ^= b; }
+
+    friend constexpr big_fixed operator<<(big_fixed a, int b) { return a <<= b; }
+    friend constexpr big_fixed operator>>(big_fixed a, int b) { return a >>= b; }
+
+    friend constexpr bool operator==(big_fixed const& a, big_fixed const& b) { return compare(a, b) == 0; }
+    friend constexpr bool operator!=(big_fixed const& a, big_fixed const& b) { return compare(a, b) != 0; }
+    friend constexpr bool operator<(big_fixed const& a, big_fixed const& b) { return compare(a, b) < 0; }
+    friend constexpr bool operator>(big_fixed const& a, big_fixed const& b) { return compare(a, b) > 0; }
+    friend constexpr bool operator<=(big_fixed const& a, big_fixed const& b) { return compare(a, b) <= 0; }
+    friend constexpr bool operator>=(big_fixed const& a, big_fixed const& b) { return compare(a, b) >= 0; }
+
+    friend std::string to_string(big_fixed const& a) {
+        limbs_t mag = (a.is_negative() ? -a : a).num;
+        std::string res;
+        do {
+            uint32_t rem = div_1(mag, 1000000000);
+            for (int k = 0; k < 9; k++) {
+                res.push_back(static_cast<char>('0' + rem % 10));
+                rem /= 10;
+            }
+        } while (used(mag) > 0);
+        while (res.size() > 1 && res.back() == '0') {
+            res.pop_back();
+        }
+        if (a.is_negative()) {
+            res.push_back('-');
+        }
+        std::reverse(res.begin(), res.end());
+        return res;
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, big_fixed const& a) {
+        return s << to_string(a);
+    }
+
+private:
+    static constexpr int compare(big_fixed const& a, big_fixed const& b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative() ? -1 : 1;
+        }
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (a.num[i] != b.num[i]) {
+                return a.num[i] < b.num[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static constexpr size_t used(limbs_t const& a) {
+        size_t n = LIMBS;
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+
+    // a = a * m + add (mod 2^Bits)
+    static constexpr void mul_1(limbs_t& a, uint32_t m, uint32_t add) {
+        uint64_t carry = add;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += static_cast<uint64_t>(a[i]) * m;
+            a[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    // a /= d, returns the remainder
+    static constexpr uint32_t div_1(limbs_t& a, uint32_t d) {
+        uint64_t rem = 0;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint64_t cur = (rem << 32) | a[i];
+            a[i] = static_cast<uint32_t>(cur / d);
+            rem = cur % d;
+        }
+        return static_cast<uint32_t>(rem);
+    }
+
+    static constexpr uint32_t shl_pair(uint32_t hi, uint32_t lo, uint32_t s) {
+        return static_cast<uint32_t>(((static_cast<uint64_t>(hi) << 32 | lo) << s) >> 32);
+    }
+
+    // Knuth's algorithm D on unsigned magnitudes.
+    static constexpr void divmod(limbs_t const& u, limbs_t const& v, limbs_t& q, limbs_t& r) {
+        size_t n = used(v);
+        size_t m = used(u);
+        if (n == 0) {
+            throw std::invalid_argument("Division by zero!");
+        }
+        q = limbs_t();
+        r = limbs_t();
+        if (m < n) {
+            r = u;
+            return;
+        }
+        if (n == 1) {
+            q = u;
+            r[0] = div_1(q, v[0]);
+            return;
+        }
+        uint32_t s = 0;
+        while ((v[n - 1] << s) >> 31 == 0) {
+            s++;
+        }
+        limbs_t vn = {};
+        std::array<uint32_t, LIMBS + 1> un = {};
+        for (size_t i = n - 1; i > 0; i--) {
+            vn[i] = shl_pair(v[i], v[i - 1], s);
+        }
+        vn[0] = v[0] << s;
+        un[m] = shl_pair(0, u[m - 1], s);
+        for (size_t i = m - 1; i > 0; i--) {
+            un[i] = shl_pair(u[i], u[i - 1], s);
+        }
+        un[0] = u[0] << s;
+
+        for (size_t j = m - n + 1; j-- > 0;) {
+            uint64_t cur = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = cur / vn[n - 1];
+            uint64_t rhat = cur % vn[n - 1];
+            while ((qhat >> 32) != 0 || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if ((rhat >> 32) != 0) {
+                    break;
+                }
+            }
+            int64_t k = 0;
+            int64_t t = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t p = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - k - static_cast<int64_t>(p & UINT32_MAX);
+                un[i + j] = static_cast<uint32_t>(t);
+                k = static_cast<int64_t>(p >> 32) - (t >> 32);
+            }
+            t = static_cast<int64_t>(un[j + n]) - k;
+            un[j + n] = static_cast<uint32_t>(t);
+            q[j] = static_cast<uint32_t>(qhat);
+            if (t < 0) {
+                q[j]--;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; i++) {
+                    carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            r[i] = static_cast<uint32_t>(((static_cast<uint64_t>(un[i + 1]) << 32 | un[i]) >> s));
+        }
+    }
+
+    static constexpr void signed_divmod(big_fixed const& a, big_fixed const& b, limbs_t& q, limbs_t& r) {
+        big_fixed ua = (a.is_negative() ? -a : a);
+        big_fixed ub = (b.is_negative() ? -b : b);
+        divmod(ua.num, ub.num, q, r);
+        if (a.is_negative() != b.is_negative()) {
+            big_fixed t;
+            t.num = q;
+            q = (-t).num;
+        }
+        if (a.is_negative()) {
+            big_fixed t;
+            t.num = r;
+            r = (-t).num;
+        }
+    }
+};
+
+template<size_t Bits>
+using big_uint = big_fixed<Bits, false>;
+
+template<size_t Bits>
+using big_int = big_fixed<Bits, true>;
+
+#endif // BIG_UINT_H
@@ -0,0 +1,47 @@
+#ifndef BINARY_SPLITTING_H
+#define BINARY_SPLITTING_H
+
+#include <cstddef>
+#include <functional>
+
+#include "big_float.h"
+#include "big_integer.h"
+
+// sum over k of a(k) * p(0) * ... * p(k) / (q(0) * ... * q(k)), the form of
+// the hypergeometric series behind pi, e and log 2.
+struct hypergeometric_series
+{
+    std::function<big_integer(size_t)> a;
+    std::function<big_integer(size_t)> p;
+    std::function<big_integer(size_t)> q;
+};
+
+// P = p(lo) * ... * p(hi - 1), Q = q(lo) * ... * q(hi - 1), and T such that
+// T / Q is the sum of the terms lo..hi-1 with the factors p(k) and q(k) of
+// k < lo left out
+struct split_product
+{
+    big_integer P;
+    big_integer Q;
+    big_integer T;
+};
+
+// Splits [lo, hi) in halves down to single terms and merges them back as
+// T = T1 * Q2 + P1 * T2, so the big multiplications are few and balanced.
+// The two halves of ranges of at least parallel_split_cutoff() terms run as
+// separate task_pool tasks.
+split_product binary_split(hypergeometric_series const& s, size_t lo, size_t hi);
+void set_parallel_split_cutoff(size_t terms);
+size_t parallel_split_cutoff();
+
+// the first terms terms of s summed to precision bits (0 for float_precision())
+big_float sum_series(hypergeometric_series const& s, size_t terms, size_t precision = 0);
+
+// by Chudnovsky's series
+big_float pi_constant(size_t precision = 0);
+// by the series of 1 / k!
+big_float e_constant(size_t precision = 0);
+// by log 2 = 3/4 * sum (-1)^k (k!)^2 / (2^k (2k + 1)!)
+big_float log2_constant(size_t precision = 0);
+
+#endif // BINARY_SPLITTING_H
@@ -0,0 +1,19 @@
+#include "limb_resource.h"
+
+static thread_local std::pmr::memory_resource* current = nullptr;
+
+std::pmr::memory_resource* limb_resource() {
+    return current != nullptr ? current : std::pmr::new_delete_resource();
+}
+
+std::pmr::memory_resource* set_limb_resource(std::pmr::memory_resource* r) {
+    std::pmr::memory_resource* res = limb_resource();
+    current = r;
+    return res;
+}
+
+limb_resource_scope::limb_resource_scope(std::pmr::memory_resource* r) : saved(set_limb_resource(r)) {}
+
+limb_resource_scope::~limb_resource_scope() {
+    set_limb_resource(saved);
+}
@@ -0,0 +1,132 @@
+#include "limb_vector.h"
+#include "limb_resource.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+limb_vector::limb_vector() : words{0, 0}, len(0) {}
+
+limb_vector::limb_vector(std::initializer_list<uint32_t> init) : limb_vector() {
+    resize(init.size());
+    std::copy(init.begin(), init.end(), data());
+}
+
+limb_vector::limb_vector(limb_vector const& other) : limb_vector() {
+    resize(other.size());
+    std::copy(other.data(), other.data() + other.size(), data());
+}
+
+limb_vector& limb_vector::operator=(limb_vector const& other) {
+    if (this != &other) {
+        size_t n = other.size();
+        if (n > capacity()) {
+            grow(n);
+        }
+        std::copy(other.data(), other.data() + n, data());
+        len = static_cast<uint32_t>(n) | (len & ON_HEAP);
+    }
+    return *this;
+}
+
+limb_vector::~limb_vector() {
+    if (on_heap()) {
+        release(heap());
+    }
+}
+
+size_t limb_vector::size() const {
+    return len & ~ON_HEAP;
+}
+
+size_t limb_vector::capacity() const {
+    return on_heap() ? heap()->cap : INLINE;
+}
+
+void limb_vector::resize(size_t n) {
+    if (n >= ON_HEAP) {
+        throw std::length_error("too many limbs");
+    }
+    size_t old = size();
+    if (n > capacity()) {
+        grow(std::max(n, 2 * capacity()));
+    }
+    if (n > old) {
+        std::fill(data() + old, data() + n, 0);
+    }
+    len = static_cast<uint32_t>(n) | (len & ON_HEAP);
+}
+
+void limb_vector::push_back(uint32_t x) {
+    resize(size() + 1);
+    back() = x;
+}
+
+void limb_vector::pop_back() {
+    len--;
+}
+
+uint32_t& limb_vector::back() {
+    return data()[size() - 1];
+}
+
+uint32_t const& limb_vector::back() const {
+    return data()[size() - 1];
+}
+
+uint32_t& limb_vector::operator[](size_t i) {
+    return data()[i];
+}
+
+uint32_t const& limb_vector::operator[](size_t i) const {
+    return data()[i];
+}
+
+uint32_t* limb_vector::data() {
+    return on_heap() ? limbs(heap()) : words;
+}
+
+uint32_t const* limb_vector::data() const {
+    return on_heap() ? limbs(heap()) : words;
+}
+
+bool limb_vector::on_heap() const {
+    return (len & ON_HEAP) != 0;
+}
+
+limb_vector::block* limb_vector::heap() const {
+    block* b;
+    std::memcpy(&b, words, sizeof(b));
+    return b;
+}
+
+void limb_vector::set_heap(block* b) {
+    std::memcpy(words, &b, sizeof(b));
+}
+
+void limb_vector::grow(size_t cap) {
+    block* b = alloc(cap);
+    size_t n = size();
+    std::copy(data(), data() + n, limbs(b));
+    if (on_heap()) {
+        release(heap());
+    }
+    set_heap(b);
+    len = static_cast<uint32_t>(n) | ON_HEAP;
+}
+
+limb_vector::block* limb_vector::alloc(size_t cap) {
+    std::pmr::memory_resource* resource = limb_resource();
+    block* b = static_cast<block*>(resource->allocate(sizeof(block) + cap * sizeof(uint32_t), alignof(block)));
+    b->resource = resource;
+    b->cap = cap;
+    return b;
+}
+
+void limb_vector::release(block* b) {
+    b->resource->deallocate(b, sizeof(block) + b->cap * sizeof(uint32_t), alignof(block));
+}
+
+uint32_t* limb_vector::limbs(block* b) {
+    return reinterpret_cast<uint32_t*>(b + 1);
+}
@@ -0,0 +1,62 @@
+#ifndef LIMB_VECTOR_H
+#define LIMB_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+
+// Limbs of a big_integer in 12 bytes: up to two limbs (a 64-bit magnitude)
+// inline, more in a block from limb_resource(). Only 4-byte aligned, so a
+// big_integer with its sign takes 16 bytes and small values never allocate.
+// Copies get their own block from the current resource; assignment reuses
+// the target's block when it is big enough.
+class limb_vector
+{
+public:
+    limb_vector();
+    limb_vector(std::initializer_list<uint32_t> init);
+    limb_vector(limb_vector const& other);
+    limb_vector& operator=(limb_vector const& other);
+    ~limb_vector();
+
+    size_t size() const;
+    size_t capacity() const;
+    // throws std::length_error past 2^31 - 1 limbs
+    void resize(size_t n);
+    void push_back(uint32_t x);
+    void pop_back();
+
+    uint32_t& back();
+    uint32_t const& back() const;
+    uint32_t& operator[](size_t i);
+    uint32_t const& operator[](size_t i) const;
+    uint32_t* data();
+    uint32_t const* data() const;
+
+private:
+    struct block
+    {
+        std::pmr::memory_resource* resource;
+        size_t cap;
+    };
+
+    static const uint32_t ON_HEAP = 1u << 31;
+    static const size_t INLINE = 2;
+
+    bool on_heap() const;
+    block* heap() const;
+    void set_heap(block* b);
+    void grow(size_t cap);
+
+    static block* alloc(size_t cap);
+    static void release(block* b);
+    static uint32_t* limbs(block* b);
+
+    // the inline limbs, or the bytes of the block pointer
+    uint32_t words[INLINE];
+    // the size, with ON_HEAP set when the limbs live in a block
+    uint32_t len;
+};
+
+#endif // LIMB_VECTOR_H
@@ -0,0 +1,183 @@
+#include "mapped_limbs.h"
+#include "limb_kernels.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static void check(bool ok, char const* what) {
+    if (!ok) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+mapped_limbs::mapped_limbs(std::string const& path, size_t len) : fd(-1), len(0), limbs(nullptr) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    check(fd >= 0, "open");
+    try {
+        resize(len);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+mapped_limbs::~mapped_limbs() {
+    unmap();
+    close(fd);
+}
+
+size_t mapped_limbs::size() const {
+    return len;
+}
+
+uint32_t* mapped_limbs::data() {
+    return limbs;
+}
+
+uint32_t const* mapped_limbs::data() const {
+    return limbs;
+}
+
+void mapped_limbs::map() {
+    if (len == 0) {
+        return;
+    }
+    void* p = mmap(nullptr, len * sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    check(p != MAP_FAILED, "mmap");
+    limbs = static_cast<uint32_t*>(p);
+}
+
+void mapped_limbs::unmap() {
+    if (limbs != nullptr) {
+        munmap(limbs, len * sizeof(uint32_t));
+        limbs = nullptr;
+    }
+}
+
+void mapped_limbs::resize(size_t new_len) {
+    unmap();
+    check(ftruncate(fd, new_len * sizeof(uint32_t)) == 0, "ftruncate");
+    len = new_len;
+    map();
+}
+
+void mapped_limbs::assign(big_integer_view a) {
+    resize(a.len);
+    std::memcpy(limbs, a.num, a.len * sizeof(uint32_t));
+}
+
+void mapped_limbs::sync() {
+    if (limbs != nullptr) {
+        check(msync(limbs, len * sizeof(uint32_t), MS_SYNC) == 0, "msync");
+    }
+}
+
+void mapped_limbs::release(size_t first, size_t n) const {
+    if (first >= len) {
+        return;
+    }
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t lo = reinterpret_cast<uintptr_t>(limbs + first);
+    uintptr_t hi = reinterpret_cast<uintptr_t>(limbs + std::min(first + n, len));
+    // only whole pages inside the range, so neighbouring blocks stay resident
+    lo = (lo + page - 1) / page * page;
+    hi = hi / page * page;
+    if (lo < hi) {
+        // the mapping is shared, so the pages are written back, not dropped
+        madvise(reinterpret_cast<void*>(lo), hi - lo, MADV_DONTNEED);
+    }
+}
+
+big_integer_view mapped_limbs::view(bool sign) const {
+    return big_integer_view(limbs, len, sign);
+}
+
+// adds c at r[from] and carries up to r[to], returns the carry out of r[to - 1]
+static uint32_t carry_into(uint32_t* r, size_t from, size_t to, uint32_t c) {
+    for (size_t i = from; i < to && c; i++) {
+        r[i] += c;
+        c = (r[i] < c);
+    }
+    return c;
+}
+
+void stream_add(mapped_limbs& res, mapped_limbs const& a, mapped_limbs const& b,
+                size_t block_limbs, stream_hook const& hook, stream_checkpoint start) {
+    if (block_limbs == 0) {
+        throw std::invalid_argument("empty block");
+    }
+    if (a.size() < b.size()) {
+        return stream_add(res, b, a, block_limbs, hook, start);
+    }
+    size_t n = a.size(), m = b.size();
+    if (res.size() != n + 1) {
+        res.resize(n + 1);
+    }
+    uint32_t* r = res.data();
+    size_t blocks = (n + block_limbs - 1) / block_limbs;
+    uint32_t carry = start.carry;
+    for (size_t k = start.block; k < blocks; k++) {
+        size_t lo = k * block_limbs;
+        size_t hi = std::min(lo + block_limbs, n);
+        size_t mid = std::max(lo, std::min(hi, m));
+        uint32_t c = (lo < mid ? add_n(r + lo, a.data() + lo, b.data() + lo, mid - lo) : 0);
+        std::copy(a.data() + mid, a.data() + hi, r + mid);
+        // a + b + carry over one block fits in the block plus one bit
+        carry = carry_into(r, lo, hi, carry) | carry_into(r, mid, hi, c);
+        if (hook) {
+            res.sync();
+            hook(stream_checkpoint{k + 1, carry}, blocks);
+        }
+        a.release(lo, hi - lo);
+        b.release(lo, hi - lo);
+        res.release(lo, hi - lo);
+    }
+    r[n] = carry;
+}
+
+void stream_mul(mapped_limbs& res, mapped_limbs const& a, mapped_limbs const& b,
+                size_t block_limbs, stream_hook const& hook, stream_checkpoint start) {
+    if (block_limbs == 0) {
+        throw std::invalid_argument("empty block");
+    }
+    size_t n = a.size(), m = b.size();
+    if (res.size() != n + m) {
+        res.resize(n + m);
+    }
+    uint32_t* r = res.data();
+    size_t na = (n + block_limbs - 1) / block_limbs, nb = (m + block_limbs - 1) / block_limbs;
+    size_t blocks = (n + m + block_limbs - 1) / block_limbs;
+    std::vector<uint32_t> high = start.high;
+    for (size_t k = start.block; k < blocks; k++) {
+        big_integer acc;
+        if (!high.empty()) {
+            acc = big_integer(big_integer_view(high.data(), high.size()));
+        }
+        for (size_t i = (k < nb ? 0 : k - nb + 1); i < na && i <= k; i++) {
+            size_t alo = i * block_limbs, blo = (k - i) * block_limbs;
+            big_integer_view x(a.data() + alo, std::min(block_limbs, n - alo));
+            big_integer_view y(b.data() + blo, std::min(block_limbs, m - blo));
+            acc += x * y;
+            a.release(alo, block_limbs);
+            b.release(blo, block_limbs);
+        }
+        size_t lo = k * block_limbs, hi = std::min(lo + block_limbs, n + m);
+        big_integer_view av(acc);
+        size_t low = std::min(av.len, hi - lo);
+        std::copy(av.num, av.num + low, r + lo);
+        std::fill(r + lo + low, r + hi, 0);
+        high.assign(av.num + low, av.num + av.len);
+        if (hook) {
+            res.sync();
+            hook(stream_checkpoint{k + 1, 0, high}, blocks);
+        }
+        res.release(lo, hi - lo);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef MAPPED_LIMBS_H
+#define MAPPED_LIMBS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "big_integer.h"
+
+// Magnitude limbs, least significant first, kept in a file and mapped into
+// memory. The kernel pages them in and out, so values larger than RAM work;
+// the stream_* functions below touch them one block at a time.
+class mapped_limbs
+{
+public:
+    // opens (creating if needed) the file and sets it to len limbs;
+    // limbs beyond the old end of the file read as zero
+    mapped_limbs(std::string const& path, size_t len);
+    mapped_limbs(mapped_limbs const&) = delete;
+    mapped_limbs& operator=(mapped_limbs const&) = delete;
+    ~mapped_limbs();
+
+    size_t size() const;
+    uint32_t* data();
+    uint32_t const* data() const;
+
+    void resize(size_t len);
+    // copies a's magnitude into the file
+    void assign(big_integer_view a);
+    // flushes dirty pages to the file
+    void sync();
+    // hints that [first, first + n) will not be needed again soon
+    void release(size_t first, size_t n) const;
+
+    big_integer_view view(bool sign = false) const;
+
+private:
+    void map();
+    void unmap();
+
+    int fd;
+    size_t len;
+    uint32_t* limbs;
+};
+
+// How far a streamed operation got: the hook receives it after every
+// block, once the result is synced, and passing it back as start resumes
+// the operation on the same files after a restart.
+struct stream_checkpoint
+{
+    size_t block = 0;
+    uint32_t carry = 0;
+    // stream_mul: what the finished blocks carry into the rest, low first
+    std::vector<uint32_t> high;
+};
+
+typedef std::function<void(stream_checkpoint const& done, size_t blocks)> stream_hook;
+
+// res = a + b, block_limbs limbs at a time with the carry chained between
+// blocks. res is resized to max(a.size(), b.size()) + 1 limbs and must not
+// be a or b.
+void stream_add(mapped_limbs& res, mapped_limbs const& a, mapped_limbs const& b,
+                size_t block_limbs, stream_hook const& hook = stream_hook(),
+                stream_checkpoint start = stream_checkpoint());
+
+// res = a * b, one block of res at a time: block k is the low part of the
+// carry from below plus every product of a block i of a and a block k - i
+// of b, worked out in memory. Each block is written once, so a restart that
+// finds a block half written just writes it again. The blocks of a, b and
+// res are released as soon as they are used, so at most one of each is
+// resident. One checkpoint per block of res. res is resized to
+// a.size() + b.size() limbs and must not be a or b.
+void stream_mul(mapped_limbs& res, mapped_limbs const& a, mapped_limbs const& b,
+                size_t block_limbs, stream_hook const& hook = stream_hook(),
+                stream_checkpoint start = stream_checkpoint());
+
+#endif // MAPPED_LIMBS_H
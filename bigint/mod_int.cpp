@@ -0,0 +1,129 @@
+#include "mod_int.h"
+#include "limb_kernels.h"
+#include "scratch_arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+mod_context::mod_context(big_integer const& m) : m(m) {
+    if (m <= 1 || !test_bit(m, 0)) {
+        throw std::invalid_argument("modulus must be odd and greater than 1");
+    }
+    big_integer_view mv(m);
+    m_limbs.assign(mv.num, mv.num + mv.len);
+    size_t n = m_limbs.size();
+    big_integer r2 = (big_integer(1) << static_cast<int>(64 * n)) % m;
+    big_integer_view rv(r2);
+    r2_limbs.assign(n, 0);
+    std::copy(rv.num, rv.num + rv.len, r2_limbs.begin());
+    // Newton on 2-adic inverses doubles the correct low bits: 1, 2, 4, ..., 64
+    uint64_t low = m_limbs[0] | (n > 1 ? static_cast<uint64_t>(m_limbs[1]) << 32 : 0);
+    uint64_t inv = 1;
+    for (int i = 0; i < 6; i++) {
+        inv *= 2 - low * inv;
+    }
+    m_inv = -inv;
+}
+
+// Separated operand scanning: the full product first, then n rows that each
+// clear its lowest remaining limb, both through the row kernels.
+void mont_mul(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    size_t n = c.limbs();
+    uint32_t const* m = c.mod();
+    scratch_limbs t(2 * n + 1);
+    t[n] = mul_1(t.data(), b, n, a[0]);
+    for (size_t i = 1; i < n; i++) {
+        t[i + n] = addmul_1(t.data() + i, b, n, a[i]);
+    }
+    t[2 * n] = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t carry = addmul_1(t.data() + i, m, n, t[i] * c.inv());
+        for (size_t k = i + n; carry != 0; k++) {
+            t[k] += carry;
+            carry = (t[k] < carry);
+        }
+    }
+    // the upper n + 1 limbs are below 2m
+    uint32_t* hi = t.data() + n;
+    if (hi[n] != 0 || cmp_n(hi, m, n) >= 0) {
+        sub_n(r, hi, m, n);
+    } else {
+        std::copy(hi, hi + n, r);
+    }
+}
+
+void mod_add(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    size_t n = c.limbs();
+    if (add_n(r, a, b, n) != 0 || cmp_n(r, c.mod(), n) >= 0) {
+        sub_n(r, r, c.mod(), n);
+    }
+}
+
+void mod_sub(uint32_t* r, uint32_t const* a, uint32_t const* b, mod_context const& c) {
+    size_t n = c.limbs();
+    if (sub_n(r, a, b, n) != 0) {
+        add_n(r, r, c.mod(), n);
+    }
+}
+
+void batch_invmod(big_integer* values, size_t count, big_integer const& m) {
+    if (m <= 1) {
+        throw std::invalid_argument("modulus must be greater than 1");
+    }
+    if (!test_bit(m, 0)) {
+        std::vector<big_integer> inv;
+        inv.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            inv.push_back(invmod(values[i], m));
+        }
+        std::copy(inv.begin(), inv.end(), values);
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    mod_context c(m);
+    size_t n = c.limbs();
+    // x[i] is values[i] and p[i] the product of values[0..i], in Montgomery form
+    std::vector<uint32_t, limb_allocator<uint32_t>> x(count * n), p(count * n), plain(n);
+    for (size_t i = 0; i < count; i++) {
+        big_integer r = values[i] % m;
+        if (r.sign) {
+            r += m;
+        }
+        big_integer_view rv(r);
+        std::fill(plain.begin(), plain.end(), 0);
+        std::copy(rv.num, rv.num + rv.len, plain.begin());
+        mont_mul(&x[i * n], plain.data(), c.r2(), c);
+        if (i == 0) {
+            std::copy(&x[0], &x[0] + n, &p[0]);
+        } else {
+            mont_mul(&p[i * n], &p[(i - 1) * n], &x[i * n], c);
+        }
+    }
+    // out of Montgomery form, invert, and back in
+    std::vector<uint32_t, limb_allocator<uint32_t>> one(n), inv(n);
+    one[0] = 1;
+    mont_mul(plain.data(), &p[(count - 1) * n], one.data(), c);
+    big_integer total = invmod(big_integer_view(plain.data(), n), m);
+    big_integer_view tv(total);
+    std::fill(plain.begin(), plain.end(), 0);
+    std::copy(tv.num, tv.num + tv.len, plain.begin());
+    mont_mul(inv.data(), plain.data(), c.r2(), c);
+    // inv is 1 / (values[0] * ... * values[i]) at step i
+    for (size_t i = count; i-- > 0;) {
+        if (i == 0) {
+            std::copy(inv.begin(), inv.end(), plain.begin());
+        } else {
+            mont_mul(plain.data(), inv.data(), &p[(i - 1) * n], c);
+            mont_mul(inv.data(), inv.data(), &x[i * n], c);
+        }
+        mont_mul(plain.data(), plain.data(), one.data(), c);
+        values[i] = big_integer(big_integer_view(plain.data(), n));
+        values[i].remFrontZero();
+    }
+}
+
+void batch_invmod(std::vector<big_integer>& values, big_integer const& m) {
+    batch_invmod(values.data(), values.size(), m);
+}
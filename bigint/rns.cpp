@@ -0,0 +1,378 @@
+#include "rns.h"
+#include "limb_kernels.h"
+#include "task_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RNS_X86 1
+#endif
+
+static std::atomic<size_t> rns_cutoff(1 << 15);
+
+void set_parallel_rns_cutoff(size_t lanes) {
+    rns_cutoff = std::max<size_t>(lanes, 1);
+}
+
+size_t parallel_rns_cutoff() {
+    return rns_cutoff;
+}
+
+static uint32_t pow_mod(uint64_t a, uint32_t e, uint32_t m) {
+    uint64_t r = 1;
+    for (a %= m; e != 0; e >>= 1) {
+        if (e & 1) {
+            r = r * a % m;
+        }
+        a = a * a % m;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+// Miller-Rabin to the bases 2, 3, 5 and 7, which has no false positives
+// below 3.2 * 10^9
+static bool is_prime(uint32_t n) {
+    if (n < 2 || n % 2 == 0) {
+        return n == 2;
+    }
+    uint32_t d = n - 1;
+    int s = 0;
+    for (; d % 2 == 0; s++) {
+        d /= 2;
+    }
+    for (uint32_t a : {2, 3, 5, 7}) {
+        if (a % n == 0) {
+            continue;
+        }
+        uint64_t x = pow_mod(a, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int i = 1; i < s && composite; i++) {
+            x = x * x % n;
+            composite = (x != n - 1);
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs f over [begin, end) ranges that cover [0, n), in parallel once n is
+// at least twice the cutoff.
+static void for_lanes(size_t n, std::function<void(size_t, size_t)> const& f) {
+    size_t cutoff = parallel_rns_cutoff();
+    if (n < 2 * cutoff) {
+        f(0, n);
+        return;
+    }
+    size_t tasks = n / cutoff;
+    task_pool::global().run(tasks, [&](size_t t) {
+        f(t * n / tasks, (t + 1) * n / tasks);
+    });
+}
+
+// Runs both halves of a tree node, in parallel for nodes of at least the
+// cutoff primes.
+static void split(size_t primes, std::function<void(size_t)> const& half) {
+    if (primes >= parallel_rns_cutoff()) {
+        std::pmr::memory_resource* resource = limb_resource();
+        task_pool::global().run(2, [&](size_t k) {
+            limb_resource_scope scope(resource);
+            half(k);
+        });
+    } else {
+        half(0);
+        half(1);
+    }
+}
+
+// The lane loops below are written once and inlined into one copy per
+// instruction set, like the big_batch kernels. Residues are below p < 2^31,
+// so a sum or Montgomery product is below 2p and min(r, r - p) reduces it:
+// r - p wraps around exactly when r < p.
+
+namespace {
+struct lane_args {
+    uint32_t* r;
+    uint32_t const* a;
+    uint32_t const* b;
+    uint32_t const* p;
+    uint32_t const* inv;
+};
+}
+
+__attribute__((always_inline))
+static inline void add_lanes(lane_args x, size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) {
+        uint32_t s = x.a[i] + x.b[i];
+        x.r[i] = std::min(s, s - x.p[i]);
+    }
+}
+
+__attribute__((always_inline))
+static inline void sub_lanes(lane_args x, size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) {
+        uint32_t d = x.a[i] - x.b[i] + x.p[i];
+        x.r[i] = std::min(d, d - x.p[i]);
+    }
+}
+
+// r = a * b / 2^32 mod p
+__attribute__((always_inline))
+static inline void mul_lanes(lane_args x, size_t lo, size_t hi) {
+    for (size_t i = lo; i < hi; i++) {
+        uint64_t t = static_cast<uint64_t>(x.a[i]) * x.b[i];
+        uint32_t u = static_cast<uint32_t>(t) * x.inv[i];
+        uint32_t m = static_cast<uint32_t>((t + static_cast<uint64_t>(u) * x.p[i]) >> 32);
+        x.r[i] = std::min(m, m - x.p[i]);
+    }
+}
+
+static void add_lanes_generic(lane_args x, size_t lo, size_t hi) {
+    add_lanes(x, lo, hi);
+}
+
+static void sub_lanes_generic(lane_args x, size_t lo, size_t hi) {
+    sub_lanes(x, lo, hi);
+}
+
+static void mul_lanes_generic(lane_args x, size_t lo, size_t hi) {
+    mul_lanes(x, lo, hi);
+}
+
+#ifdef RNS_X86
+__attribute__((target("avx2")))
+static void add_lanes_avx2(lane_args x, size_t lo, size_t hi) {
+    add_lanes(x, lo, hi);
+}
+
+__attribute__((target("avx2")))
+static void sub_lanes_avx2(lane_args x, size_t lo, size_t hi) {
+    sub_lanes(x, lo, hi);
+}
+
+__attribute__((target("avx2")))
+static void mul_lanes_avx2(lane_args x, size_t lo, size_t hi) {
+    mul_lanes(x, lo, hi);
+}
+
+__attribute__((target("avx512f")))
+static void add_lanes_avx512(lane_args x, size_t lo, size_t hi) {
+    add_lanes(x, lo, hi);
+}
+
+__attribute__((target("avx512f")))
+static void sub_lanes_avx512(lane_args x, size_t lo, size_t hi) {
+    sub_lanes(x, lo, hi);
+}
+
+__attribute__((target("avx512f")))
+static void mul_lanes_avx512(lane_args x, size_t lo, size_t hi) {
+    mul_lanes(x, lo, hi);
+}
+#endif
+
+namespace {
+typedef void (*lane_kernel)(lane_args, size_t, size_t);
+
+struct lane_kernel_table {
+    lane_kernel add;
+    lane_kernel sub;
+    lane_kernel mul;
+};
+}
+
+// indexed by limb_tier; the adx tier has nothing to add here
+static lane_kernel_table const TABLES[] = {
+    {add_lanes_generic, sub_lanes_generic, mul_lanes_generic},
+#ifdef RNS_X86
+    {add_lanes_generic, sub_lanes_generic, mul_lanes_generic},
+    {add_lanes_avx2, sub_lanes_avx2, mul_lanes_avx2},
+    {add_lanes_avx512, sub_lanes_avx512, mul_lanes_avx512},
+#endif
+};
+
+static lane_kernel_table const& kernels() {
+    return TABLES[static_cast<size_t>(active_limb_tier())];
+}
+
+static void run(lane_kernel k, lane_args x, size_t n) {
+    for_lanes(n, [&](size_t lo, size_t hi) {
+        k(x, lo, hi);
+    });
+}
+
+rns_basis::rns_basis(size_t bits) {
+    // M > 2^(bits + 1) leaves room for the sign; the logarithms only pick
+    // the count, with a bit to spare against rounding
+    double have = 0;
+    for (uint32_t p = (1u << 31) - 1; have < bits + 2.0; p -= 2) {
+        if (is_prime(p)) {
+            primes.push_back(p);
+            have += std::log2(static_cast<double>(p));
+        }
+    }
+    size_t k = primes.size();
+    inv.resize(k);
+    r2.resize(k);
+    weights.resize(k);
+    for (size_t i = 0; i < k; i++) {
+        uint32_t p = primes[i], x = 1;
+        for (int j = 0; j < 5; j++) {
+            x *= 2 - p * x;
+        }
+        inv[i] = -x;
+        r2[i] = static_cast<uint32_t>((static_cast<uint64_t>(pow_mod(2, 32, p)) << 32) % p);
+    }
+    tree.resize(4 * k);
+    build(1, 0, k);
+    cofactors(1, 0, k, big_integer(1) % tree[1]);
+}
+
+size_t rns_basis::size() const {
+    return primes.size();
+}
+
+uint32_t rns_basis::prime(size_t i) const {
+    return primes[i];
+}
+
+big_integer const& rns_basis::product() const {
+    return tree[1];
+}
+
+void rns_basis::build(size_t v, size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        tree[v] = big_integer(primes[lo]);
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    build(2 * v, lo, mid);
+    build(2 * v + 1, mid, hi);
+    tree[v] = tree[2 * v] * tree[2 * v + 1];
+}
+
+// c is M / tree[v] modulo tree[v]; at a leaf that is M / p mod p, whose
+// inverse is the CRT weight of p
+void rns_basis::cofactors(size_t v, size_t lo, size_t hi, big_integer const& c) {
+    if (hi - lo == 1) {
+        weights[lo] = big_integer_view(invmod(c, tree[v])).num[0];
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    cofactors(2 * v, lo, mid, c * tree[2 * v + 1] % tree[2 * v]);
+    cofactors(2 * v + 1, mid, hi, c * tree[2 * v] % tree[2 * v + 1]);
+}
+
+// x is below tree[v]; out[lo..hi) = x mod each prime
+void rns_basis::reduce(size_t v, size_t lo, size_t hi, big_integer const& x, uint32_t* out) const {
+    if (hi - lo == 1) {
+        out[lo] = big_integer_view(x).num[0];
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    split(hi - lo, [&](size_t k) {
+        size_t c = 2 * v + k;
+        reduce(c, k == 0 ? lo : mid, k == 0 ? mid : hi, x % tree[c], out);
+    });
+}
+
+// the sum of c[i] * M / prime(i) over [lo, hi), divided by M / tree[v]
+big_integer rns_basis::combine(size_t v, size_t lo, size_t hi, uint32_t const* c) const {
+    if (hi - lo == 1) {
+        return big_integer(c[lo]);
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    big_integer l, r;
+    split(hi - lo, [&](size_t k) {
+        if (k == 0) {
+            l = combine(2 * v, lo, mid, c);
+            l *= tree[2 * v + 1];
+        } else {
+            r = combine(2 * v + 1, mid, hi, c);
+            r *= tree[2 * v];
+        }
+    });
+    return l += r;
+}
+
+rns_int::rns_int(rns_basis const& b) : res(b.size()), base(&b) {}
+
+rns_int::rns_int(rns_basis const& b, big_integer const& x) : res(b.size()), base(&b) {
+    big_integer r = x % b.product();
+    if (r.sign) {
+        r += b.product();
+    }
+    b.reduce(1, 0, b.size(), r, res.data());
+    run(kernels().mul, lane_args{res.data(), res.data(), b.r2.data(), b.primes.data(), b.inv.data()}, res.size());
+}
+
+rns_basis const& rns_int::basis() const {
+    return *base;
+}
+
+big_integer rns_int::value() const {
+    // out of Montgomery form and times the weights in one multiplication
+    lanes_t c(res.size());
+    run(kernels().mul, lane_args{c.data(), res.data(), base->weights.data(), base->primes.data(), base->inv.data()}, c.size());
+    big_integer x = base->combine(1, 0, base->size(), c.data());
+    x %= base->product();
+    if (x + x > base->product()) {
+        x -= base->product();
+    }
+    return x;
+}
+
+uint32_t rns_int::residue(size_t i) const {
+    uint32_t one = 1, r;
+    mul_lanes_generic(lane_args{&r, &res[i], &one, &base->primes[i], &base->inv[i]}, 0, 1);
+    return r;
+}
+
+void rns_int::check(rns_int const& rhs) const {
+    if (base != rhs.base) {
+        throw std::invalid_argument("values of different bases");
+    }
+}
+
+rns_int& rns_int::operator+=(rns_int const& rhs) {
+    check(rhs);
+    run(kernels().add, lane_args{res.data(), res.data(), rhs.res.data(), base->primes.data(), base->inv.data()}, res.size());
+    return *this;
+}
+
+rns_int& rns_int::operator-=(rns_int const& rhs) {
+    check(rhs);
+    run(kernels().sub, lane_args{res.data(), res.data(), rhs.res.data(), base->primes.data(), base->inv.data()}, res.size());
+    return *this;
+}
+
+rns_int& rns_int::operator*=(rns_int const& rhs) {
+    check(rhs);
+    run(kernels().mul, lane_args{res.data(), res.data(), rhs.res.data(), base->primes.data(), base->inv.data()}, res.size());
+    return *this;
+}
+
+rns_int rns_int::operator-() const {
+    rns_int r(*base);
+    return r -= *this;
+}
+
+rns_int operator+(rns_int a, rns_int const& b) {
+    return a += b;
+}
+
+rns_int operator-(rns_int a, rns_int const& b) {
+    return a -= b;
+}
+
+rns_int operator*(rns_int a, rns_int const& b) {
+    return a *= b;
+}
@@ -0,0 +1,68 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Per-thread stack of limbs for the temporaries inside the big_integer
+// operators. Blocks are taken and given back in LIFO order, so once the
+// arena has grown to the working set no operator calls malloc for scratch.
+class scratch_arena
+{
+public:
+    static scratch_arena& local();
+
+    uint32_t* push(size_t n);
+    // n must match the latest push that is still outstanding
+    void pop(size_t n);
+
+    // grows the arena to at least limbs limbs in total
+    void reserve(size_t limbs);
+    // frees the memory no outstanding block is using
+    void trim();
+    size_t capacity() const;
+    size_t used() const;
+
+private:
+    struct chunk
+    {
+        std::unique_ptr<uint32_t[]> limbs;
+        size_t size;
+        size_t used;
+    };
+
+    void add_chunk(size_t size);
+
+    std::vector<chunk> chunks;
+    size_t top = 0;
+};
+
+// Uninitialised limbs borrowed from the calling thread's arena. Objects
+// must be destroyed in reverse order of construction, which block scope
+// guarantees.
+class scratch_limbs
+{
+public:
+    explicit scratch_limbs(size_t n);
+    scratch_limbs(scratch_limbs const&) = delete;
+    scratch_limbs& operator=(scratch_limbs const&) = delete;
+    ~scratch_limbs();
+
+    uint32_t* data();
+    size_t size() const;
+    uint32_t& operator[](size_t i);
+
+private:
+    uint32_t* limbs;
+    size_t n;
+};
+
+// Sizes the calling thread's arena for a known workload up front; about
+// 4 * (limbs of the largest operand) + 8 covers one division.
+void scratch_reserve(size_t limbs);
+size_t scratch_capacity();
+void scratch_trim();
+
+#endif // SCRATCH_ARENA_H
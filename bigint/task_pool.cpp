@@ -0,0 +1,137 @@
+#include "task_pool.h"
+
+#include <algorithm>
+
+task_pool& task_pool::global() {
+    static task_pool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+task_pool::task_pool(size_t threads) {
+    start(threads > 0 ? threads - 1 : 0);
+}
+
+task_pool::~task_pool() {
+    stop();
+}
+
+void task_pool::set_threads(size_t threads) {
+    stop();
+    start(threads > 0 ? threads - 1 : 0);
+}
+
+size_t task_pool::threads() const {
+    return workers.size() + 1;
+}
+
+void task_pool::start(size_t count) {
+    stopping = false;
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+void task_pool::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    workers.clear();
+}
+
+task_pool::job* task_pool::claim(job* j, size_t& index) {
+    if (j == nullptr) {
+        while (!jobs.empty() && jobs.front()->next == jobs.front()->n) {
+            jobs.pop_front();
+        }
+        if (jobs.empty()) {
+            return nullptr;
+        }
+        j = jobs.front();
+    }
+    if (j->next == j->n) {
+        return nullptr;
+    }
+    index = j->next++;
+    return j;
+}
+
+void task_pool::execute(job* j, size_t index) {
+    try {
+        (*j->f)(index);
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!j->error) {
+            j->error = std::current_exception();
+        }
+    }
+    // the caller may return and free j as soon as done reaches n
+    size_t n = j->n;
+    if (++j->done == n) {
+        // under the lock, so the caller is either before its check or waiting
+        std::lock_guard<std::mutex> guard(lock);
+        wake.notify_all();
+    }
+}
+
+void task_pool::work() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        size_t index;
+        job* j = claim(nullptr, index);
+        if (j != nullptr) {
+            guard.unlock();
+            execute(j, index);
+            guard.lock();
+        } else if (stopping) {
+            return;
+        } else {
+            wake.wait(guard);
+        }
+    }
+}
+
+void task_pool::run(size_t n, std::function<void(size_t)> const& f) {
+    if (workers.empty() || n < 2) {
+        for (size_t i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+    job own;
+    own.f = &f;
+    own.n = n;
+    own.next = 0;
+    own.done = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(&own);
+    }
+    wake.notify_all();
+    std::unique_lock<std::mutex> guard(lock);
+    while (own.done != n) {
+        size_t index;
+        job* j = claim(&own, index);
+        if (j == nullptr) {
+            j = claim(nullptr, index);
+        }
+        if (j != nullptr) {
+            guard.unlock();
+            execute(j, index);
+            guard.lock();
+        } else {
+            // woken by a new job or by the last task of one finishing
+            wake.wait(guard);
+        }
+    }
+    // workers only reach a job through the queue, under the lock
+    jobs.erase(std::remove(jobs.begin(), jobs.end(), &own), jobs.end());
+    guard.unlock();
+    if (own.error) {
+        std::rethrow_exception(own.error);
+    }
+}
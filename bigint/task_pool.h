@@ -0,0 +1,63 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads for splitting big multiplications. The thread that calls
+// run takes part in its own job and, once nothing of it is left to start,
+// picks up work from other jobs while it waits, so tasks may run nested
+// jobs without tying up the workers. With nothing to pick up it sleeps
+// until a new job arrives or a job's last task finishes.
+class task_pool
+{
+public:
+    // starts with one thread per hardware thread
+    static task_pool& global();
+
+    explicit task_pool(size_t threads);
+    task_pool(task_pool const&) = delete;
+    task_pool& operator=(task_pool const&) = delete;
+    ~task_pool();
+
+    // threads counts the caller, so 1 runs every job inline; must not be
+    // called while a job is running
+    void set_threads(size_t threads);
+    size_t threads() const;
+
+    // calls f(0), ..., f(n - 1), possibly in parallel, and returns once all
+    // have finished; rethrows the first exception one of them threw
+    void run(size_t n, std::function<void(size_t)> const& f);
+
+private:
+    struct job
+    {
+        std::function<void(size_t)> const* f;
+        size_t n;
+        size_t next;
+        std::atomic<size_t> done;
+        std::exception_ptr error;
+    };
+
+    void start(size_t workers);
+    void stop();
+    void work();
+    // under lock: claims the next index of j, or of the oldest job if j is null
+    job* claim(job* j, size_t& index);
+    void execute(job* j, size_t index);
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<job*> jobs;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+#endif // TASK_POOL_H